@@ -43,6 +43,8 @@ MFILE out;
 #include <stdint.h>
 #include <cinttypes>
 
+#include "sieveFile.h"    // copy from partiallySieveless/ into this folder
+
 
 
 /*
@@ -339,42 +341,32 @@ int main(int argc, char **argv) {
 
 
 
-  /* open the 2^k1 sieve file */
-
-  FILE* fp;
-  size_t file_size;
+  /* open the 2^k1 sieve file (see sieveFile.h) */
 
   // make the following smaller if you want more BOINC checkpoints to occur
-  const uint64_t bufferBytes = (uint64_t)1 << 10;    // 2^1 bytes = 1 kiB
+  const uint64_t checkpointPatterns = (uint64_t)1 << 9;    // 2^9 patterns = 1 kiB of sieve
 
-  // I will load only a single chunk of 2^k1 sieve into RAM at a time
   char input_path_sieve[512];
   boinc_resolve_filename(file, input_path_sieve, sizeof(input_path_sieve));
-  fp = boinc_fopen(input_path_sieve, "rb");
-  uint16_t* data = (uint16_t*)malloc(bufferBytes);
-
-  // Check file size
-  // Bytes in sieve file are 2^(k1 - 7)
-  fseek(fp, 0, SEEK_END);
-  file_size = ftell(fp);
-  if ( file_size != ((size_t)1 << (k1 - 7)) ) {
+  struct sieveFile sf;
+  if ( sieveOpen(&sf, input_path_sieve, k1) ) {
     out.printf("  error: wrong sieve file!\n");
     fprintf(stderr, "  error: wrong sieve file!\n");
     exit(-1);
   }
 
-  // for handling the buffer...
-  uint64_t bufferStepMax = bufferBytes >> 1;   // since each pattern is 2 bytes
-  uint64_t bufferStep = bufferStepMax;
-  uint16_t bytes;    // the current 2 bytes
-
   /*
-    Seek to necessary part of the file
+    Get the 2^(TASK_SIZE - 8) patterns needed from the file
     Note that ((((uint64_t)1 << k1) - 1) & bStart) equals bStart % ((uint64_t)1 << k1)
+    A checkpoint is taken care of by starting the pattern loop at checkp
   */
-  fseek(fp, ((((uint64_t)1 << k1) - 1) & bStart) >> 7, SEEK_SET);
-  // take care of checkpoint
-  fseek(fp, 2 * checkp, SEEK_CUR);
+  const uint16_t* data = sieveLoad(&sf, ((((uint64_t)1 << k1) - 1) & bStart) >> 8, (uint64_t)1 << (TASK_SIZE - 8));
+  if (!data) {
+    out.printf("  error: cannot read sieve file! Aborting.\n");
+    fprintf(stderr, "  error: cannot read sieve file! Aborting.\n");
+    exit(-1);
+  }
+  uint16_t bytes;    // the current 2 bytes
 
 
 
@@ -447,10 +439,8 @@ next:
 
   for (uint64_t pattern = checkp; pattern < patternEnd; pattern++) {
 
-    // get bytes
-    if (bufferStep >= bufferStepMax) {    // do we need to refresh buffer?
-
-        // first, do some BOINC stuff
+    // do some BOINC stuff
+    if ((pattern - checkp) % checkpointPatterns == 0) {
         boinc_fraction_done((double)pattern/patternEndDouble);
         if (boinc_time_to_checkpoint()) {
             retval = do_checkpoint(pattern, countB, checksum_alpha);
@@ -462,13 +452,8 @@ next:
             }
             boinc_checkpoint_completed();
         }
-
-        // read from 2^k1 sieve
-        fread(data, sizeof(uint16_t), bufferBytes / sizeof(uint16_t), fp);
-        bufferStep = 0;
     }
-    bytes = data[bufferStep];
-    bufferStep++;
+    bytes = data[pattern];    // get bytes from 2^k1 sieve
 
     for (int bit = 0; bit < 16; bit ++) {      // loop over 16 bits in pattern
 
@@ -607,6 +592,8 @@ next:
   fprintf(stderr, "  Checksum = ");
   print128(checksum_alpha);
 
+  sieveClose(&sf);
+
 
 
 
@@ -0,0 +1,200 @@
+#!/usr/bin/env python3.7
+# Combines the JSON lines written by my CPU-only codes when run with --json file
+#   (see partiallySieveless/collatzJson.h).
+#
+# Each line is one task, (task_id0, task_id), so a search of many tasks on many
+#   computers gives many files, which this reads one line at a time, so the files
+#   can be very large.
+#
+# This reports...
+#   how many tasks, and how many were run more than once
+#   tasks run more than once that disagree in countB or in checksum,
+#     which finds computers that make errors (such as from RAM without ECC)
+#   the total countB, numbers tested, and seconds
+#   the total checksum and the largest max n (if the codes were compiled with -DCHECKSUM)
+#   every overflow, where any not finished using 256 bits must be
+#     carefully checked (see collatzTestOverflow.c)
+#   for reduceTo1/collatzSieveless_reduceTo1.c, the smallest nStart found for each steps,
+#     and any nStart that reached the steps limit
+#   with --missing, the task_id that are missing for each task_id0,
+#     up to the largest task_id seen (or up to --task_idEnd)
+# Lines that aren't JSON, such as a line cut short by a crash, are counted then skipped.
+# Tasks only match if they have the same code, k, k1, k2, deltaN, MOD3_POWER, TASK_SIZE,
+#   and TASK_SIZE0, since the checksum depends on all of these.
+# If the files have more than one of these groups, the totals are printed for each group,
+#   so that checksums of different k2 (for example) are never added together.
+#
+# Run using something like...
+#   python3 collatzAggregate.py log1.jsonl log2.jsonl
+#   cat *.jsonl | python3 collatzAggregate.py - --missing
+#   python3 collatzAggregate.py *.jsonl | ./collatzTestOverflow -
+# since unfinished overflows are printed like "Overflow! nStart = ..."
+# The exit status is 1 if any tasks disagree.
+#
+# (c) 2021 Bradley Knockel
+
+
+import argparse
+import json
+import sys
+
+
+
+# which tasks can be compared (collatzCoordinator.py also uses these)
+groupKeys = ("code", "k", "k1", "k2", "deltaN", "MOD3_POWER", "TASK_SIZE", "TASK_SIZE0")
+
+def groupOf(r):
+  return tuple(r.get(key) for key in groupKeys)
+
+def groupName(g):
+  return " ".join([str(g[0])] + ["%s=%s" % (key, value) for key, value in zip(groupKeys[1:], g[1:])])
+
+
+
+# the ranges [start, end) of 0 <= id < end that aren't in the sorted list ids
+def gaps(ids, end):
+  out = []
+  last = -1
+  for id in ids + [end]:
+    if id > last + 1:
+      out.append((last + 1, min(id, end)))
+    last = id
+  return [g for g in out if g[0] < g[1]]
+
+
+
+def main():
+  parser = argparse.ArgumentParser(description="Combines the --json output of my CPU-only Collatz codes")
+  parser.add_argument("files", nargs="+", help="JSON lines files (- for stdin)")
+  parser.add_argument("--missing", action="store_true", help="list the missing task_id for each task_id0")
+  parser.add_argument("--task_idEnd", type=int, default=None,
+                      help="with --missing, task_id should go up to task_idEnd - 1")
+  args = parser.parse_args()
+
+  tasks = {}          # (group, task_id0, task_id): (countB, checksum)
+  totals = {}         # group: the totals of its tasks
+  records = 0
+  badLines = 0
+  duplicates = 0
+  conflicts = 0
+  overflows = {}      # nStart: finished
+  listFull = False
+  finds = {}          # steps: smallest nStart
+  stepsLimit = set()  # nStart
+
+  for name in args.files:
+    f = sys.stdin if name == "-" else open(name)
+    for lineNumber, line in enumerate(f, 1):
+      line = line.strip()
+      if not line:
+        continue
+      try:
+        r = json.loads(line)
+        key = (groupOf(r), int(r["task_id0"]), int(r["task_id"]))
+        rCountB = int(r["countB"])
+      except (ValueError, KeyError, TypeError):
+        badLines += 1
+        print("  skipping bad line %s:%d" % (name, lineNumber))
+        continue
+      records += 1
+      rChecksum = int(r["checksum"]) if "checksum" in r else None
+
+      # the same task again?
+      if key in tasks:
+        duplicates += 1
+        oldCountB, oldChecksum = tasks[key]
+        bad = oldCountB != rCountB
+        if oldChecksum is not None and rChecksum is not None:
+          bad = bad or oldChecksum != rChecksum
+        if bad:
+          conflicts += 1
+          print("  error: %s task_id0=%d task_id=%d disagrees (%s:%d)" % (groupName(key[0]), key[1], key[2], name, lineNumber))
+        if oldChecksum is None and rChecksum is not None:
+          tasks[key] = (rCountB, rChecksum)
+        continue
+      tasks[key] = (rCountB, rChecksum)
+
+      t = totals.setdefault(key[0], {"countB": 0, "numbers": 0, "seconds": 0.0,
+          "checksum": 0, "hasChecksum": False, "maxN": -1, "maxNstart": None})
+      t["countB"] += rCountB
+      t["numbers"] += int(r.get("numbers", 0))
+      t["seconds"] += float(r.get("seconds", 0.0))
+      if rChecksum is not None:
+        t["hasChecksum"] = True
+        t["checksum"] += rChecksum
+        n = int(r["max_n"])
+        nStart = int(r["max_n_nStart"])
+        if n > t["maxN"] or (n == t["maxN"] and nStart < t["maxNstart"]):
+          t["maxN"] = n
+          t["maxNstart"] = nStart
+      for o in r.get("overflow_list", []):
+        nStart = int(o["nStart"])
+        overflows[nStart] = overflows.get(nStart, False) or bool(o["finished"])
+      if r.get("overflow_list_full"):
+        listFull = True
+      for o in r.get("finds", []):
+        steps = int(o["steps"])
+        nStart = int(o["nStart"])
+        if steps not in finds or nStart < finds[steps]:
+          finds[steps] = nStart
+      for o in r.get("steps_limit_list", []):
+        stepsLimit.add(int(o["nStart"]))
+
+    if f is not sys.stdin:
+      f.close()
+
+  print("lines read = %d" % records)
+  print("bad lines skipped = %d" % badLines)
+  print("tasks = %d" % len(tasks))
+  print("tasks run more than once = %d" % duplicates)
+  print("tasks that disagree = %d" % conflicts)
+
+  for g in sorted(totals, key=str):
+    t = totals[g]
+    indent = ""
+    if len(totals) > 1:
+      print("%s:" % groupName(g))
+      indent = "  "
+    print(indent + "countB = %d" % t["countB"])
+    if t["numbers"]:
+      print(indent + "numbers tested = %d" % t["numbers"])
+    print(indent + "seconds = %e" % t["seconds"])
+    if t["hasChecksum"]:
+      print(indent + "checksum = %d" % t["checksum"])
+      print(indent + "max n = %d" % t["maxN"])
+      print(indent + "max n is for nStart = %d" % t["maxNstart"])
+
+  print("overflows = %d" % len(overflows))
+  for nStart in sorted(overflows):
+    if overflows[nStart]:
+      print("  256 bits were enough for nStart = %d" % nStart)
+    else:
+      print("  Overflow! nStart = %d" % nStart)
+  if listFull:
+    print("  warning: a code found too many overflows to list them all (see the logs)")
+
+  # like the grep and sort of log.txt in reduceTo1/README.md
+  if finds:
+    print("smallest nStart for each steps found = %d" % len(finds))
+    for steps in sorted(finds):
+      print("  steps = %d found. nStart = %d" % (steps, finds[steps]))
+  for nStart in sorted(stepsLimit):
+    print("  Steps limit reached! nStart = %d" % nStart)
+
+  if args.missing:
+    ids = {}     # (group, task_id0): set of task_id
+    for g, id0, id in tasks:
+      ids.setdefault((g, id0), set()).add(id)
+    for (g, id0) in sorted(ids, key=lambda x: (str(x[0]), x[1])):
+      end = args.task_idEnd if args.task_idEnd is not None else max(ids[(g, id0)]) + 1
+      missing = gaps(sorted(ids[(g, id0)]), end)
+      print("missing for %s task_id0=%d = %d" % (groupName(g), id0, sum(b - a for a, b in missing)))
+      if missing:
+        print("    " + ", ".join(str(a) if b == a + 1 else "%d-%d" % (a, b - 1) for a, b in missing))
+
+  return 1 if conflicts else 0
+
+
+
+if __name__ == "__main__":
+  sys.exit(main())
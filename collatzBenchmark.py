@@ -0,0 +1,241 @@
+#!/usr/bin/env python3.7
+# Benchmarks my CPU-only codes on the same fixed tasks, then saves the results as JSON.
+#
+# Getting exact speeds is difficult because each task has a different part of the sieve,
+#   so every code is run on the same pinned (task_id0, task_id) with the same
+#   k, TASK_SIZE, TASK_SIZE0, and k1, which are set using command-line options
+#   (see partiallySieveless/collatzParams.h).
+#
+# For each code and task, this reports...
+#   countB, the numbers in the sieve segment that needed testing
+#   numbers tested, which the sieveless codes print themselves,
+#     and which is otherwise countB * 5 * 2^(TASK_SIZE0 - k) since the 3^2 sieve
+#     lets exactly 5 of every 9 a through (see partiallySieveless/collatzMod3.h
+#     for --cflags with -DMOD3_POWER=m, where 3^m must divide the 9 * 2^(TASK_SIZE0 - k) a)
+#   total seconds
+#   seconds to make the sieve segment, which the sieveless codes print themselves,
+#     and which is otherwise found by running again with TASK_SIZE0 = k,
+#     which only tests 9 a values for each b
+#   numbers per second, both total and for just testing numbers
+#
+# Run from the main folder of this repository using something like...
+#   python3 collatzBenchmark.py
+#   python3 collatzBenchmark.py --cflags "-O3 -march=native -fopenmp" --out new.json
+#   python3 collatzBenchmark.py --compare old.json
+# The codes are compiled into a folder called "benchmark", which is also where
+#   a small 2^k1 sieve is made (using collatzCreateSieve.c) if it isn't there yet.
+# With --compare, a different countB is an error, and the speeds are compared.
+#
+# (c) 2021 Bradley Knockel
+
+
+import argparse
+import json
+import os
+import platform
+import re
+import subprocess
+import sys
+import time
+
+
+
+# name: (source file, compiler, uses a sieve file)
+codes = {
+  "sieveless_npp": ("sieveless/collatzSieveless_npp.c", "gcc", False),
+  "sieveless_repeatedKsteps": ("sieveless/collatzSieveless_repeatedKsteps.c", "gcc", False),
+  "partiallySieveless_npp": ("partiallySieveless/collatzPartiallySieveless_npp.c", "gcc", True),
+  "partiallySieveless_npp_128byHand": ("partiallySieveless/collatzPartiallySieveless_npp_128byHand.cpp", "g++", True),
+  "partiallySieveless_repeatedKsteps": ("partiallySieveless/collatzPartiallySieveless_repeatedKsteps.c", "gcc", True),
+}
+
+# for a 3^m sieve, (3^m, how many of every 3^m a are tested), if 3^m divides the a of a task
+mod3Tested = {0: (1, 1), 1: (3, 2), 2: (9, 5)}
+
+# the pinned tasks (task_id0, task_id)
+# task_id must be less than 2^(k - TASK_SIZE)
+tasks = [(0, 0), (0, 12345), (1, 777777), (3, 1048575), (5, 2000000000)]
+
+# the same parameters are used by every code
+params = {"k": 51, "TASK_SIZE": 20, "TASK_SIZE0": 61}
+k1 = 27
+
+
+
+def run(cmd, cwd):
+  return subprocess.run(cmd, cwd=cwd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+      universal_newlines=True)
+
+
+
+# makes the 2^k1 sieve file in folder if it isn't there yet
+def makeSieve(folder, cflags):
+  sieve = "sieve" + str(k1)
+  if os.path.exists(os.path.join(folder, sieve)):
+    return sieve
+  print("making", sieve)
+  src = open("partiallySieveless/collatzCreateSieve.c").read()
+  src = re.sub(r"const int k = \d+;", "const int k = %i;" % k1, src, count=1)
+  open(os.path.join(folder, "createSieve.c"), "w").write(src)
+  includes = ["-I" + os.path.abspath("partiallySieveless")]
+  out = run(["gcc"] + cflags + includes + ["createSieve.c", "-o", "createSieve"], folder)
+  if out.returncode:
+    sys.exit(out.stdout)
+  out = run(["./createSieve"], folder)
+  if out.returncode:
+    sys.exit(out.stdout)
+  os.rename(os.path.join(folder, "sieve"), os.path.join(folder, sieve))
+  return sieve
+
+
+
+def compileCode(folder, name, cflags):
+  src, compiler, _ = codes[name]
+  includes = ["-I" + os.path.abspath("partiallySieveless")]
+  out = run([compiler] + cflags + includes + [os.path.abspath(src), "-o", name], folder)
+  if out.returncode:
+    sys.exit("could not compile " + name + "\n" + out.stdout)
+
+
+
+# runs the code once, returning countB, seconds, overflows,
+#   seconds making the sieve, and numbers tested (None if the code doesn't print them)
+def runCode(folder, name, options, task):
+  out = run(["./" + name] + options + [str(task[0]), str(task[1])], folder)
+  countB = re.search(r"needed testing = (\d+)", out.stdout)
+  seconds = re.search(r"([0-9.e+-]+) seconds$", out.stdout, re.M)
+  sieveSeconds = re.search(r"([0-9.e+-]+) seconds making sieve", out.stdout)
+  numbers = re.search(r"numbers tested = (\d+)", out.stdout)
+  if out.returncode or not countB or not seconds:
+    sys.exit(name + " failed\n" + out.stdout)
+  overflows = len(re.findall(r"Overflow!", out.stdout))
+  if sieveSeconds:
+    sieveSeconds = float(sieveSeconds.group(1))
+  if numbers:
+    numbers = int(numbers.group(1))
+  return int(countB.group(1)), float(seconds.group(1)), overflows, sieveSeconds, numbers
+
+
+
+# the m of the 3^m sieve of the code (see partiallySieveless/collatzMod3.h)
+def mod3Power(name, cflags):
+  if name == "partiallySieveless_npp_128byHand":
+    return 2      # doesn't use collatzMod3.h
+  m = 2
+  for flag in cflags:
+    match = re.fullmatch(r"-DMOD3_POWER=(\d+)", flag)
+    if match:
+      m = int(match.group(1))
+  return m
+
+
+
+def main():
+  parser = argparse.ArgumentParser(description="Benchmarks my CPU-only Collatz codes")
+  parser.add_argument("--cflags", default="-O3", help="compiler flags (default: -O3)")
+  parser.add_argument("--repeat", type=int, default=3, help="runs per task, fastest is kept")
+  parser.add_argument("--codes", default=",".join(codes), help="comma-separated codes to run")
+  parser.add_argument("--out", default="benchmark.json", help="JSON file for the results")
+  parser.add_argument("--compare", help="JSON file of a previous benchmark")
+  args = parser.parse_args()
+
+  folder = "benchmark"
+  os.makedirs(folder, exist_ok=True)
+  cflags = args.cflags.split()
+  names = args.codes.split(",")
+  for name in names:
+    if name not in codes:
+      sys.exit("unknown code " + name)
+
+  sieve = None
+  if any(codes[name][2] for name in names):
+    sieve = makeSieve(folder, cflags)
+
+  results = []
+  for name in names:
+    compileCode(folder, name, cflags)
+
+    options = []
+    for key, value in params.items():
+      options += ["--" + key, str(value)]
+    if codes[name][2]:
+      options += ["--k1", str(k1), "--sieve", sieve]
+    sieveOptions = options + ["--TASK_SIZE0", str(params["k"])]   # just 9 a per b
+
+    for task in tasks:
+      seconds = sieveSeconds = float("inf")
+      for i in range(args.repeat):
+        countB, s, overflows, sieveS, numbers = runCode(folder, name, options, task)
+        if sieveS is None:
+          sieveS = runCode(folder, name, sieveOptions, task)[1]
+        if s < seconds:
+          seconds = s
+          sieveSeconds = sieveS
+
+      if numbers is None:
+        m = mod3Power(name, cflags)
+        if m not in mod3Tested:
+          sys.exit("%s doesn't print the numbers tested, and 3^%d doesn't divide the a of a task,"
+              " so it can't be benchmarked with -DMOD3_POWER=%d" % (name, m, m))
+        numbers = (countB * 9 << (params["TASK_SIZE0"] - params["k"])) // mod3Tested[m][0] * mod3Tested[m][1]
+      testSeconds = max(seconds - sieveSeconds, 1e-9)
+      result = {
+        "code": name,
+        "task_id0": task[0],
+        "task_id": task[1],
+        "countB": countB,
+        "overflows": overflows,
+        "numbers": numbers,
+        "seconds": seconds,
+        "sieveSeconds": sieveSeconds,
+        "testSeconds": testSeconds,
+        "numbersPerSecond": numbers / seconds,
+        "testNumbersPerSecond": numbers / testSeconds,
+      }
+      results.append(result)
+      print("%-36s %i %10i  countB = %7i  %e numbers/second  (sieve %.1f%%)" % (name, task[0],
+          task[1], countB, result["numbersPerSecond"], 100.0 * sieveSeconds / seconds))
+      sys.stdout.flush()
+
+  report = {
+    "time": time.strftime("%Y-%m-%d %H:%M:%S"),
+    "machine": platform.machine(),
+    "processor": platform.processor(),
+    "system": platform.platform(),
+    "cpus": os.cpu_count(),
+    "compiler": run(["gcc", "--version"], ".").stdout.split("\n")[0],
+    "cflags": args.cflags,
+    "params": dict(params, k1=k1),
+    "results": results,
+  }
+  with open(args.out, "w") as f:
+    json.dump(report, f, indent=2)
+  print("saved to", args.out)
+
+
+
+  # compare to a previous benchmark
+  if args.compare:
+    old = json.load(open(args.compare))
+    if old["params"] != report["params"]:
+      print("warning: the previous benchmark used different parameters")
+    oldResults = {(r["code"], r["task_id0"], r["task_id"]): r for r in old["results"]}
+    bad = 0
+    for r in results:
+      o = oldResults.get((r["code"], r["task_id0"], r["task_id"]))
+      if not o:
+        continue
+      if o["countB"] != r["countB"] or o["overflows"] != r["overflows"]:
+        print("ERROR: %s %i %i has countB = %i (was %i)" % (r["code"], r["task_id0"],
+            r["task_id"], r["countB"], o["countB"]))
+        bad += 1
+        continue
+      print("%-36s %i %10i  %.3f times the previous speed" % (r["code"], r["task_id0"],
+          r["task_id"], r["numbersPerSecond"] / o["numbersPerSecond"]))
+    if bad:
+      sys.exit(1)
+
+
+
+if __name__ == "__main__":
+  main()
@@ -0,0 +1,323 @@
+#!/usr/bin/env python3.7
+# Runs all the task_id of a task_id0 using my CPU-only codes, keeping track of which
+#   task_id are done so that no chunk is silently left unfinished.
+#
+# For each task_id0, every task_id from 0 to 2^(k - TASK_SIZE) - 1 must be run,
+#   else the results of the whole task_id0 are useless. Instead of
+#     seq -f %1.0f 0 1048575 | parallel -P 2 ./a.out 0 |tee -a log.txt &
+#   and changing the start value of seq to pick up where you left off, use...
+#     python3 collatzCoordinator.py ./a.out 0 -P 2
+#   which runs -P copies of the code at a time, each with a different task_id.
+#
+# The ledger is a file of the JSON lines written by --json (see partiallySieveless/collatzJson.h),
+#   one for each task_id that finished, so collatzAggregate.py can also read it.
+# Each code writes to its own temporary file, and only after it finishes are its lines
+#   appended to the ledger (then flushed to disk), so, if the computer crashes or
+#   if you stop this script, just run it again to pick up where you left off.
+# A task_id that doesn't finish (the code fails or is killed) is run again up to --retries times,
+#   picking up where it left off if --options has --checkpoint (see partiallySieveless/collatzCheckpoint.h).
+# The output of the codes is appended to --log so that any "Overflow!" lines are kept
+#   (see collatzTestOverflow.c).
+# When every task_id of a task_id0 is in the ledger, this prints that it is fully covered.
+#
+# k, TASK_SIZE, and TASK_SIZE0 are given to the code (see partiallySieveless/collatzParams.h),
+#   so they are always the same as in the ledger. Other options can be given using --options.
+# A task_id only counts as done if its line in the ledger also has the same code, k1, k2,
+#   deltaN, and MOD3_POWER (like in collatzAggregate.py), but these come from the code and
+#   its options, so they are only known once a task_id finishes. Until then, only one code runs.
+#   If the ledger has just one set of these, it is assumed at first, so that its
+#   task_id aren't run again.
+# collatzPartiallySieveless_repeatedKsteps.c can run a range of task_id in one process,
+#   which is used if --chunk is more than 1 (each process then uses all its OpenMP threads).
+# It can also be started once with --worker then be sent task_id through stdin, so that its
+#   tables are only made once. Use --worker here to start -P of these instead of a code for
+#   each job (set OMP_NUM_THREADS=1 to run one per core). A worker that dies is started again.
+#
+# Run from the folder of the code using something like...
+#   python3 collatzCoordinator.py ./a.out 0 -P 4
+#   python3 collatzCoordinator.py ./a.out 0 1 2 --options "--k1 37 --sieve sieve37" --chunk 16 -P 1
+#   python3 collatzCoordinator.py ./a.out 5 --start 0 --end 1000 --ledger ledger5.jsonl
+#   OMP_NUM_THREADS=1 python3 collatzCoordinator.py ./a.out 0 --worker -P 4 --TASK_SIZE 14
+#
+# (c) 2021 Bradley Knockel
+
+
+import argparse
+import json
+import os
+import queue
+import shlex
+import subprocess
+import sys
+from collections import deque
+from concurrent.futures import ThreadPoolExecutor, wait, FIRST_COMPLETED
+
+from collatzAggregate import groupOf, groupName
+
+
+
+# what is kept for each task_id that is done
+def summary(r):
+  return (int(r["countB"]), int(r["checksum"]) if "checksum" in r else None)
+
+
+
+# reads the ledger, returning {group: {task_id0: {task_id: summary}}} for records with these parameters
+# group is from groupOf() of collatzAggregate.py
+def readLedger(ledger, params):
+  done = {}
+  if not os.path.exists(ledger):
+    return done
+  with open(ledger) as f:
+    for lineNumber, line in enumerate(f, 1):
+      try:
+        r = json.loads(line)
+        if any(r.get(key) != value for key, value in params.items()):
+          continue
+        done.setdefault(groupOf(r), {}).setdefault(int(r["task_id0"]), {})[int(r["task_id"])] = summary(r)
+      except (ValueError, KeyError, TypeError):
+        print("  skipping bad line %s:%d" % (ledger, lineNumber))
+  return done
+
+
+
+# appends lines to the ledger, and makes sure they are on the disk
+def appendLedger(ledger, lines):
+  with open(ledger, "a") as f:
+    f.write("".join(lines))
+    f.flush()
+    os.fsync(f.fileno())
+
+
+
+# the task_id that aren't done as ranges [a, b) of at most chunk task_id
+# This is a generator because there can be billions of task_id
+def makeJobs(task_id0s, start, end, done, chunk):
+  for id0 in task_id0s:
+    doneIDs = done.get(id0, {})
+    job = None
+    for id in range(start, end):
+      if id in doneIDs:
+        continue
+      if job and job[2] == id and job[2] - job[1] < chunk:
+        job[2] += 1
+        continue
+      if job:
+        yield job
+      job = [id0, id, id + 1]
+    if job:
+      yield job
+
+
+
+# runs the code on task_id0 and a <= task_id < b, returning its output and JSON lines
+def runJob(cmd, tmp, job):
+  id0, a, b = job
+  if os.path.exists(tmp):
+    os.remove(tmp)
+  ids = [str(id0), str(a)] + ([str(b)] if b - a > 1 else [])
+  out = subprocess.run(cmd + ["--json", tmp] + ids, stdout=subprocess.PIPE,
+      stderr=subprocess.STDOUT, universal_newlines=True)
+  lines = []
+  if os.path.exists(tmp):
+    lines = open(tmp).readlines()
+    os.remove(tmp)
+  return out.returncode, out.stdout, lines
+
+
+
+# starts a code with --worker (only for partiallySieveless_repeatedKsteps), which writes JSON lines to tmp
+def startWorker(cmd, tmp):
+  return subprocess.Popen(cmd + ["--worker", "--json", tmp], stdin=subprocess.PIPE,
+      stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+
+
+
+# like runJob() but sends the job to an idle worker, starting it again if it died
+def runWorkerJob(cmd, workers, job):
+  id0, a, b = job
+  worker, tmp = workers.get()
+  try:
+    if worker is None or worker.poll() is not None:
+      worker = startWorker(cmd, tmp)
+    if os.path.exists(tmp):
+      os.remove(tmp)
+    output = []
+    returncode = 1
+    try:
+      worker.stdin.write("%d %d %d\n" % (id0, a, b))
+      worker.stdin.flush()
+      for line in worker.stdout:
+        output.append(line)
+        if line.startswith("worker: "):
+          returncode = 0 if line.startswith("worker: done") else 1
+          break
+    except OSError:
+      pass
+    if not (output and output[-1].startswith("worker: ")):
+      worker.kill()      # it died or stopped talking, so start a new one next time
+      worker.wait()
+    lines = []
+    if os.path.exists(tmp):
+      lines = open(tmp).readlines()
+      os.remove(tmp)
+    return returncode, "".join(output), lines
+  finally:
+    workers.put((worker, tmp))
+
+
+
+def main():
+  parser = argparse.ArgumentParser(description="Runs and keeps track of the task_id of my CPU-only Collatz codes")
+  parser.add_argument("program", help="the compiled code, such as ./a.out")
+  parser.add_argument("task_id0", type=int, nargs="+", help="task_id0 to run")
+  parser.add_argument("-P", type=int, default=os.cpu_count(), help="how many codes to run at a time")
+  parser.add_argument("--k", type=int, default=51)
+  parser.add_argument("--TASK_SIZE", type=int, default=20)
+  parser.add_argument("--TASK_SIZE0", type=int, default=67)
+  parser.add_argument("--options", default="", help="other options for the code, such as \"--k2 13\"")
+  parser.add_argument("--start", type=int, default=0, help="first task_id to run")
+  parser.add_argument("--end", type=int, default=None, help="run task_id < end (default: all of them)")
+  parser.add_argument("--chunk", type=int, default=1, help="task_id per process (only for partiallySieveless_repeatedKsteps)")
+  parser.add_argument("--worker", action="store_true", help="start -P codes with --worker and send them the jobs")
+  parser.add_argument("--retries", type=int, default=3, help="times to rerun a task_id that doesn't finish")
+  parser.add_argument("--ledger", default="ledger.jsonl", help="JSON lines file of finished task_id")
+  parser.add_argument("--log", default="log.txt", help="file for the output of the codes")
+  args = parser.parse_args()
+
+  params = {"k": args.k, "TASK_SIZE": args.TASK_SIZE, "TASK_SIZE0": args.TASK_SIZE0}
+  maxTaskID = 1 << (args.k - args.TASK_SIZE)
+  end = maxTaskID if args.end is None else min(args.end, maxTaskID)
+  cmd = [args.program] + shlex.split(args.options)
+  for key, value in params.items():
+    cmd += ["--" + key, str(value)]
+
+  # a crash could have cut the last line short, so start a new line
+  if os.path.exists(args.ledger) and os.path.getsize(args.ledger):
+    with open(args.ledger, "rb") as f:
+      f.seek(-1, os.SEEK_END)
+      if f.read(1) != b"\n":
+        appendLedger(args.ledger, ["\n"])
+
+  # the task_id to run if done has the task_id that are done
+  def toRun(done):
+    return sum(end - args.start - sum(args.start <= id < end for id in done.get(id0, {})) for id0 in args.task_id0)
+
+  ledger = readLedger(args.ledger, params)
+  group = None        # the parameters of the code, once a task_id finishes
+  guess = next(iter(ledger)) if len(ledger) == 1 else None
+  done = ledger.get(guess, {})
+  if guess:
+    print("parameters from the ledger are %s" % groupName(guess))
+  if len(ledger) > 1:
+    print("the ledger has more than one set of parameters, so a task_id must finish to know which")
+  total = toRun(done)
+  print("task_id to run = %d (task_id must be less than %d)" % (total, maxTaskID))
+  sys.stdout.flush()
+
+  jobs = makeJobs(args.task_id0, args.start, end, done, args.chunk)
+  retry = deque()     # task_id to run again
+  tries = {}          # (task_id0, task_id): times run
+  failed = []
+  finished = 0
+  log = open(args.log, "a")
+
+  # idle workers and their temporary files
+  workers = queue.Queue()
+  for i in range(args.P if args.worker else 0):
+    workers.put((None, "%s.worker%d.tmp" % (args.ledger, i)))
+
+  with ThreadPoolExecutor(max_workers=args.P) as pool:
+    running = {}
+
+    # keeps P codes running (only 1 until the parameters of the code are known)
+    def fill():
+      while len(running) < (args.P if group else 1):
+        job = retry.popleft() if retry else next(jobs, None)
+        if job is None:
+          return
+        if args.worker:
+          running[pool.submit(runWorkerJob, cmd, workers, job)] = job
+        else:
+          tmp = "%s.%d.%d.tmp" % (args.ledger, job[0], job[1])
+          running[pool.submit(runJob, cmd, tmp, job)] = job
+
+    fill()
+    while running:
+      future = next(iter(wait(running, return_when=FIRST_COMPLETED).done))
+      id0, a, b = running.pop(future)
+      returncode, output, lines = future.result()
+
+      # keep only the lines of this job (a line cut short by a crash is not kept)
+      good = {}
+      for line in lines:
+        try:
+          r = json.loads(line)
+          id = int(r["task_id"])
+          if group is None and returncode == 0 and all(r.get(key) == value for key, value in params.items()):
+            group = groupOf(r)
+            print("parameters are %s" % groupName(group))
+            if ledger and group != guess:
+              # start over with the task_id that are done for these parameters
+              done = ledger.get(group, {})
+              total = toRun(done) + sum(id in done.get(id0, {}) for id in range(a, b))   # this job counts too
+              print("task_id to run = %d (task_id must be less than %d)" % (total, maxTaskID))
+              jobs = makeJobs(args.task_id0, args.start, end, done, args.chunk)
+              retry.clear()
+          if int(r["task_id0"]) == id0 and a <= id < b and groupOf(r) == group:
+            good[id] = (summary(r), line if line.endswith("\n") else line + "\n")
+        except (ValueError, KeyError, TypeError):
+          pass
+      if returncode:
+        good = {}
+
+      log.write(output)
+      log.flush()
+      if good:
+        appendLedger(args.ledger, [good[id][1] for id in sorted(good)])
+        for id in good:
+          done.setdefault(id0, {})[id] = good[id][0]
+        finished += len(good)
+        print("task_id0 = %d, task_id = %d to %d done (%d of %d)" % (id0, a, b - 1, finished, total))
+
+      # run again the task_id that didn't finish
+      for id in range(a, b):
+        if id in good:
+          continue
+        tries[(id0, id)] = tries.get((id0, id), 0) + 1
+        if tries[(id0, id)] <= args.retries:
+          print("  rerunning task_id0 = %d, task_id = %d" % (id0, id))
+          retry.append([id0, id, id + 1])
+        else:
+          print("  error: task_id0 = %d, task_id = %d failed (see %s)" % (id0, id, args.log))
+          failed.append((id0, id))
+      sys.stdout.flush()
+      fill()
+
+  log.close()
+
+  # end of stdin tells the workers to stop
+  while not workers.empty():
+    worker, tmp = workers.get()
+    if worker is not None and worker.poll() is None:
+      worker.stdin.close()
+      worker.wait()
+
+  # which task_id0 are fully covered?
+  for id0 in args.task_id0:
+    records = done.get(id0, {})
+    if len(records) == maxTaskID:
+      print("task_id0 = %d is fully covered" % id0)
+      print("  countB = %d" % sum(r[0] for r in records.values()))
+      if all(r[1] is not None for r in records.values()):
+        print("  checksum = %d" % sum(r[1] for r in records.values()))
+    else:
+      print("task_id0 = %d is missing %d task_id" % (id0, maxTaskID - len(records)))
+  if failed:
+    print("failed task_id = %d" % len(failed))
+    sys.exit(1)
+
+
+
+if __name__ == "__main__":
+  main()
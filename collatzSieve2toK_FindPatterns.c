@@ -9,6 +9,10 @@ Practically no RAM is used.
 Compile and run via something like...
   clang -O3 collatzSieve2toK_FindPatterns.c
   time ./a.out >> log.txt
+Requires partiallySieveless/collatzJoin.h, which finds if a number joins
+  the path of one of the previous deltaN numbers using a hash table
+  (up to about 200 bytes of RAM per deltaN),
+  and partiallySieveless/collatzKsteps.h, which does k steps using a lookup table.
 
 Something like the following can eventually be useful
 after putting all k < 40 into log.txt...
@@ -182,6 +186,8 @@ This is a minor improvement worth doing!
 #include <sys/time.h>
 struct timeval tv1, tv2;
 
+#include "partiallySieveless/collatzJoin.h"
+
 
 //  k = 36 could take an hour to run
 const int k = 32;
@@ -257,7 +263,8 @@ int32_t binarySearch(int32_t l, int32_t r, __uint128_t bytes) {
 int main(void) {
 
   int j;
-  uint64_t b, b0, count, m, deltaN, lenList, n0, maxM;
+  uint64_t b0, count, m, deltaN, n0, maxM;
+  __uint128_t b;   // becomes fk(b0)
   int temp;  // acts as a boolean for various things
 
 
@@ -302,9 +309,14 @@ int main(void) {
   printf("\n");
   fflush(stdout);
 
-  // in the following lists, the 0th element is for n0
-  uint64_t* nList = (uint64_t*)malloc((deltaN+1)*sizeof(uint64_t));
-  int* cList = (int*)malloc((deltaN+1)*sizeof(int));
+  // for finding if n0 joins the path of n0 - deltaN ... n0 - 1
+  //   (kt is a lookup table for doing k steps)
+  struct kstepsTable kt;
+  struct joinTable jt;
+  if ( kstepsInit(&kt, KSTEPS_BITS) || joinInit(&jt, &kt, k, deltaN) ) {
+    printf("  error: not enough RAM for deltaN!\n");
+    return 0;
+  }
 
 
 
@@ -346,40 +358,18 @@ int main(void) {
     temp = 1;
 
     // check to see if if 2^k*N + b0 is reduced in no more than k steps
-    b = b0;
-    for (j=1; j<=k; j++) {  // step
-      if (b & 1) {          // bitwise test for odd
-        b = 3*(b/2) + 2;    // note that b is odd
-      } else {
-        b >>= 1;
-        if (b <= b0) {
-          if (b==b0 && b0>1) {printf("  wow!\n");}
-          temp = 0;
-          break;
-        }
-      }
+    //   (the steps stop once b <= b0, and b and c are then fk(b0) if not reduced)
+    int c;
+    if ( kstepsReduce(&kt, b0, b0 + 1, k, &b, &c) ) {
+      if (b==b0 && b0>1) {printf("  wow!\n");}
+      temp = 0;
     }
 
     // if temp=1, use another method to try to get temp=0
     if (temp) {
       n0 = b0;   // it helps my brain to rename it
-      lenList = ((deltaN+1) < (n0-1)) ? (deltaN+1) : (n0-1) ;   // get min(deltaN+1, n0-1)
-      for(m=0; m<lenList; m++) nList[m] = n0-m;    // initialize nList
-      for(m=0; m<lenList; m++) cList[m] = 0;       // initialize cList
-
-      for(m=0; m<lenList; m++) {      // loop over lists
-
-        for(j=1; j<=k; j++) {         // steps
-          if (nList[m] & 1) {                 // bitwise test for odd
-            nList[m] = 3*(nList[m]/2) + 2;    // note that nList[m] is odd
-            cList[m]++;
-          } else {
-            nList[m] >>= 1;
-          }
-        }
-
-        // check against 0th element
-        if ( m>0 && nList[m]==nList[0] && cList[m]==cList[0] ) {
+      m = joinCheck(&jt, n0, b, c);
+      if (m) {
 /*
             if (j<=19 && n0%64!=15 && n0%128!=95 && n0%256!=63 && n0%512!=383 && n0%1024!=255 && n0%2048!=1535 && n0%4096!=1023 && n0%8192!=6143 && n0%16384!=4095 && n0%32768!=24575 && n0%65536!=16383 && n0%131072!=98303 && n0%262144!=65535 && n0%262144!=183295 && n0%262144!=190207 && n0%262144!=199423 && n0%262144!=236031 && n0%262144!=242175 && n0%262144!=121471 && n0%524288!=2815 && n0%524288!=45567 && n0%524288!=201151 && n0%524288!=255743 && n0%524288!=257727 && n0%524288!=264959 && n0%524288!=296959 && n0%524288!=301567 && n0%524288!=307711 && n0%524288!=390271 && n0%524288!=393215 && n0%524288!=449151 && n0%524288!=506879 && n0%524288!=510975){
               printf("  oh no!\n");
@@ -393,9 +383,6 @@ int main(void) {
             deltaNcounts[m]++;
 
             temp = 0;
-            break;
-        }
-
       }
     }
 
@@ -540,5 +527,7 @@ int main(void) {
 
 
   free(patterns);
+  joinFree(&jt);
+  kstepsFree(&kt);
   return 0;
 }
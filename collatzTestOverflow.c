@@ -0,0 +1,450 @@
+/* ******************************************
+
+Checks numbers that overflowed when using 128-bit integers.
+This does what collatzTestOverflow.py does, but it is fast enough for
+  checking every overflow in a large pile of log files.
+
+The numbers come from the arguments. Each argument is either a number
+  or a log file from one of my codes, in which every line like
+    Overflow! nStart = 274133054632352106267
+  is found. Use - to read a log from stdin.
+Lines like "Overflow! 256 bits were enough for nStart = ..." are already checked
+  by the CPU codes (see partiallySieveless/collatzOverflow256.h), so they are skipped.
+If a log has a line like "k = 51", that k is used for its numbers' A and B,
+  where nStart = A * 2^k + B.
+Otherwise, k is set by --k (see partiallySieveless/collatzParams.h).
+
+For each nStart, this code prints...
+  A and B
+  the peak (the largest number the path gets to)
+  how many steps it takes to drop below nStart
+  how many steps it takes to get to 1
+where a step is n -> n/2 or n -> (3*n + 1)/2, just like collatzTestOverflow.py.
+If the path never reaches 1 in maxSteps steps, this is printed too,
+  and the number should be checked very carefully!
+
+Numbers are 256-bit (4 limbs of 64 bits).
+If a number gets larger than that, GMP is used for the rest of its path
+  if compiled with -DUSE_GMP (GMP is slow, so it is only used when needed).
+Otherwise, the number is reported and should be checked with collatzTestOverflow.py.
+
+Compile and run via something like...
+  gcc -O3 -fopenmp collatzTestOverflow.c
+  ./a.out log1.txt log2.txt
+  ./a.out --k 51 55247846101001863167
+or, to also handle numbers past 256 bits...
+  gcc -O3 -fopenmp -DUSE_GMP collatzTestOverflow.c -lgmp
+The log files are read in parallel, and then the numbers are checked in parallel.
+Without -fopenmp, a single CPU thread is used.
+Each nStart is only checked once, even if many log lines have it.
+
+(c) 2021 Bradley Knockel
+
+****************************************** */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef USE_GMP
+#include <gmp.h>
+#endif
+
+// only the options, since the rules of paramsCheck() are for the codes that make the logs
+#define PARAMS_NO_CHECK
+#include "partiallySieveless/collatzParams.h"
+
+
+
+int k = 51;
+
+int maxSteps = 100000;
+
+
+
+// Prints __uint128_t numbers since printf("%llu\n", x) doesn't work
+//   since "long long" is only 64-bit in gcc.
+// This function works for any non-negative integer less than 128 bits.
+void print128(__uint128_t n) {
+  char a[40] = { '\0' };
+  char *p = a + 39;
+  if (n==0) { *--p = (char)('0'); }
+  else { for (; n != 0; n /= 10) *--p = (char)('0' + n % 10); }
+  printf("%s\n", p);
+  fflush(stdout);
+}
+
+
+
+// Like print128() but for 256-bit numbers, where w[0] is the lowest 64 bits
+void print256(const uint64_t w[4]) {
+  uint64_t n[4] = {w[0], w[1], w[2], w[3]};
+  char a[80] = { '\0' };
+  char *p = a + 79;
+  do {
+    // divide n by 10, 64 bits at a time, getting the remainder
+    __uint128_t r = 0;
+    for (int i = 3; i >= 0; i--) {
+      __uint128_t x = (r << 64) | n[i];
+      n[i] = (uint64_t)(x / 10);
+      r = x % 10;
+    }
+    *--p = (char)('0' + (int)r);
+  } while (n[0] | n[1] | n[2] | n[3]);
+  printf("%s\n", p);
+  fflush(stdout);
+}
+
+
+
+// how many bits are needed for the 256-bit number
+int bits256(const uint64_t w[4]) {
+  for (int i = 3; i >= 0; i--)
+    if (w[i]) return 64*i + 64 - __builtin_clzll(w[i]);
+  return 0;
+}
+
+// returns 1 if x > y
+static inline int greater256(const uint64_t x[4], const uint64_t y[4]) {
+  for (int i = 3; i >= 0; i--)
+    if (x[i] != y[i]) return x[i] > y[i];
+  return 0;
+}
+
+
+
+struct overflowResult {
+  __uint128_t nStart;
+  int k;                 // for A and B
+  uint64_t peak[4];      // if peakBits <= 256
+  int peakBits;
+  char* peakStr;         // if peakBits > 256 (from GMP)
+  int tooBig;            // 1 if larger than 256 bits without GMP
+  int64_t stepsBelow;    // -1 if not found
+  int64_t stepsTo1;      // -1 if not found
+};
+
+
+
+#ifdef USE_GMP
+// continues the path of r using GMP from n, which is larger than 256 bits
+static void checkGMP(struct overflowResult* r, mpz_t n, int64_t steps) {
+
+  mpz_t peak, start;
+  mpz_init_set(peak, n);
+  mpz_init(start);
+  mpz_import(start, 2, -1, sizeof(uint64_t), 0, 0, (uint64_t[2]){(uint64_t)r->nStart, (uint64_t)(r->nStart >> 64)});
+
+  for (; steps < maxSteps; ) {
+    if ( mpz_odd_p(n) ) {
+      mpz_mul_ui(n, n, 3);
+      mpz_add_ui(n, n, 1);
+      mpz_fdiv_q_2exp(n, n, 1);
+      if ( mpz_cmp(n, peak) > 0 ) mpz_set(peak, n);
+    } else {
+      mpz_fdiv_q_2exp(n, n, 1);
+    }
+    steps++;
+    if ( r->stepsBelow < 0 && mpz_cmp(n, start) < 0 ) r->stepsBelow = steps;
+    if ( mpz_cmp_ui(n, 1) == 0 ) {
+      r->stepsTo1 = steps;
+      break;
+    }
+  }
+
+  r->peakBits = (int)mpz_sizeinbase(peak, 2);
+  r->peakStr = mpz_get_str(NULL, 10, peak);
+  mpz_clear(peak);
+  mpz_clear(start);
+}
+#endif
+
+
+
+// follows the path of r->nStart
+static void checkOverflow(struct overflowResult* r) {
+
+  uint64_t n[4] = {(uint64_t)r->nStart, (uint64_t)(r->nStart >> 64), 0, 0};
+  uint64_t start[4] = {n[0], n[1], 0, 0};
+  int64_t steps = 0;
+
+  memcpy(r->peak, n, sizeof(n));
+  r->peakStr = NULL;
+  r->tooBig = 0;
+  r->stepsBelow = -1;
+  r->stepsTo1 = -1;
+
+  if ( r->nStart <= 1 ) {
+    r->peakBits = bits256(r->peak);
+    r->stepsTo1 = 0;
+    return;
+  }
+
+  for (; steps < maxSteps; ) {
+
+    if (n[0] & 1) {
+
+      // (3*n + 1)/2 = n + (n >> 1) + 1 since n is odd
+      uint64_t h[4];
+      for (int i = 0; i < 3; i++) h[i] = (n[i] >> 1) | (n[i+1] << 63);
+      h[3] = n[3] >> 1;
+      __uint128_t carry = 1;
+      for (int i = 0; i < 4; i++) {
+        carry += (__uint128_t)n[i] + h[i];
+        n[i] = (uint64_t)carry;
+        carry >>= 64;
+      }
+
+      if (carry) {    // larger than 256 bits
+#ifdef USE_GMP
+        mpz_t big;
+        mpz_init(big);
+        mpz_import(big, 4, -1, sizeof(uint64_t), 0, 0, n);
+        mpz_setbit(big, 256);
+        checkGMP(r, big, steps + 1);
+        mpz_clear(big);
+#else
+        r->tooBig = 1;
+        r->peakBits = 257;
+#endif
+        return;
+      }
+
+      if ( greater256(n, r->peak) ) memcpy(r->peak, n, sizeof(n));
+
+    } else {
+      for (int i = 0; i < 3; i++) n[i] = (n[i] >> 1) | (n[i+1] << 63);
+      n[3] >>= 1;
+    }
+    steps++;
+
+    if ( r->stepsBelow < 0 && greater256(start, n) ) r->stepsBelow = steps;
+    if ( n[0] == 1 && !(n[1] | n[2] | n[3]) ) {
+      r->stepsTo1 = steps;
+      break;
+    }
+  }
+
+  r->peakBits = bits256(r->peak);
+}
+
+
+
+/*
+  Reads a number of up to 128 bits
+  Returns 0 if it worked
+*/
+static int read128(const char* s, __uint128_t* n) {
+  const __uint128_t UINTmax = -1;
+  *n = 0;
+  if ( *s < '0' || *s > '9' ) return 1;
+  for (; *s >= '0' && *s <= '9'; s++) {
+    int d = *s - '0';
+    if ( *n > (UINTmax - d) / 10 ) return 1;
+    *n = 10 * (*n) + d;
+  }
+  return 0;
+}
+
+
+
+// a growing list of the numbers to check
+struct overflowList {
+  struct overflowResult* r;
+  size_t count;
+  size_t size;
+  size_t lines;     // lines of logs that had overflow
+};
+
+static int listAdd(struct overflowList* list, __uint128_t nStart, int kk) {
+  if ( list->count == list->size ) {
+    size_t size = list->size ? 2*list->size : 1024;
+    struct overflowResult* r = (struct overflowResult*)realloc(list->r, size * sizeof(struct overflowResult));
+    if (!r) return 1;
+    list->r = r;
+    list->size = size;
+  }
+  list->r[list->count].nStart = nStart;
+  list->r[list->count].k = kk;
+  list->count++;
+  return 0;
+}
+
+
+
+/*
+  Finds the overflows in a log file (or stdin if filename is -)
+  Returns 0 if it worked
+*/
+static int readLog(const char* filename, struct overflowList* list) {
+
+  FILE* fp = strcmp(filename, "-") ? fopen(filename, "r") : stdin;
+  if (!fp) {
+    printf("  error: cannot open %s!\n", filename);
+    return 1;
+  }
+
+  const char* tag = "Overflow! nStart = ";
+  int kk = k;
+  char line[512];
+  while (fgets(line, sizeof(line), fp)) {
+    int kLog;
+    if ( sscanf(line, " k = %d", &kLog) == 1 ) kk = kLog;
+
+    char* p = strstr(line, tag);
+    if (!p) continue;
+    list->lines++;
+    __uint128_t nStart;
+    if ( read128(p + strlen(tag), &nStart) ) {
+      printf("  error: cannot read the number in %s: %s", filename, p);
+      continue;
+    }
+    if ( listAdd(list, nStart, kk) ) {
+      printf("  error: not enough RAM!\n");
+      break;
+    }
+  }
+
+  if (fp != stdin) fclose(fp);
+  return 0;
+}
+
+
+
+static int compareResults(const void* x, const void* y) {
+  __uint128_t a = ((const struct overflowResult*)x)->nStart;
+  __uint128_t b = ((const struct overflowResult*)y)->nStart;
+  return (a > b) - (a < b);
+}
+
+
+
+int main(int argc, char *argv[]) {
+
+  // read options such as --k 51 (see collatzParams.h)
+  struct collatzParam params[] = {
+    {"k", &k, NULL, 0},
+    {"maxSteps", &maxSteps, NULL, 0},
+    {NULL, NULL, NULL, 0}
+  };
+  argc = paramsParse(params, argc, argv);
+  if ( argc < 0 ) return 0;
+  if ( k < 1 || k > 127 || maxSteps < 1 ) {
+    printf("  error: need 1 <= k <= 127 and maxSteps >= 1!\n");
+    return 0;
+  }
+
+  if ( argc < 2 ) {
+    printf("Give numbers or log files to check. Aborting.\n");
+    return 0;
+  }
+
+
+
+  /* get the numbers (each log file is read by its own CPU thread) */
+
+  struct overflowList* lists = (struct overflowList*)calloc(argc, sizeof(struct overflowList));
+
+#ifdef _OPENMP
+  #pragma omp parallel for schedule(dynamic, 1)
+#endif
+  for (int i = 1; i < argc; i++) {
+    __uint128_t nStart;
+    if ( strcmp(argv[i], "-") && !read128(argv[i], &nStart) && argv[i][strspn(argv[i], "0123456789")] == '\0' ) {
+      lists[i].lines = 1;
+      listAdd(&lists[i], nStart, k);
+    } else {
+      readLog(argv[i], &lists[i]);
+    }
+  }
+
+  struct overflowList all = {NULL, 0, 0, 0};
+  for (int i = 1; i < argc; i++) {
+    all.lines += lists[i].lines;
+    for (size_t j = 0; j < lists[i].count; j++)
+      if ( listAdd(&all, lists[i].r[j].nStart, lists[i].r[j].k) ) {
+        printf("  error: not enough RAM!\n");
+        return 0;
+      }
+    free(lists[i].r);
+  }
+  free(lists);
+
+  // only check each nStart once
+  size_t count = 0;
+  if (all.count) {
+    qsort(all.r, all.count, sizeof(struct overflowResult), compareResults);
+    count = 1;
+    for (size_t i = 1; i < all.count; i++)
+      if ( all.r[i].nStart != all.r[count-1].nStart ) all.r[count++] = all.r[i];
+  }
+
+
+
+  /* check the numbers */
+
+#ifdef _OPENMP
+  #pragma omp parallel for schedule(dynamic, 1)
+#endif
+  for (size_t i = 0; i < count; i++) {
+    checkOverflow(&all.r[i]);
+  }
+
+
+
+  /* print the results */
+
+  size_t really = 0;       // really needed more than 128 bits
+  size_t notDone = 0;      // did not reach 1
+  size_t maxI = 0;         // has the largest peak
+
+  for (size_t i = 0; i < count; i++) {
+    struct overflowResult* r = &all.r[i];
+
+    printf("nStart = ");
+    print128(r->nStart);
+    printf("  For k = %i\n", r->k);
+    printf("   A = ");
+    print128(r->nStart >> r->k);
+    printf("   B = ");
+    print128(r->nStart & ( ((__uint128_t)1 << r->k) - 1 ));
+
+    if ( r->tooBig ) {
+      printf("  peak is larger than 256 bits! Check with collatzTestOverflow.py or compile with -DUSE_GMP\n\n");
+      notDone++;
+      continue;
+    }
+
+    printf("  peak = ");
+    if ( r->peakStr ) printf("%s\n", r->peakStr);
+    else print256(r->peak);
+    printf("  bits of peak = %i\n", r->peakBits);
+    printf("  steps to drop below nStart = %lli\n", (long long)r->stepsBelow);
+    printf("  steps to 1 = %lli\n", (long long)r->stepsTo1);
+    if ( r->stepsTo1 < 0 ) {
+      printf("  did not get to 1 in %i steps!\n", maxSteps);
+      notDone++;
+    }
+    printf("\n");
+
+    if ( r->peakBits > 128 ) really++;
+    if ( r->peakBits > all.r[maxI].peakBits
+         || ( r->peakBits == all.r[maxI].peakBits && r->peakBits <= 256 && greater256(r->peak, all.r[maxI].peak) ) )
+      maxI = i;
+  }
+
+  printf("lines with overflow = %zu\n", all.lines);
+  printf("numbers checked = %zu\n", count);
+  printf("numbers with a peak of more than 128 bits = %zu\n", really);
+  printf("numbers that did not get to 1 = %zu\n", notDone);
+  if (count) {
+    printf("largest peak is for nStart = ");
+    print128(all.r[maxI].nStart);
+  }
+
+  for (size_t i = 0; i < count; i++) free(all.r[i].peakStr);
+  free(all.r);
+  return 0;
+}
@@ -1,6 +1,7 @@
 #!/usr/bin/env python3.7
 # This code is for checking numbers that overflowed when using 128-bit integers.
 # Integers in Python 3 are of unlimited size!
+# To check all the overflows in log files, collatzTestOverflow.c is much faster.
 
 
 
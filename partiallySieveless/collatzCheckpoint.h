@@ -0,0 +1,202 @@
+/* ******************************************
+
+Checkpoints for my CPU-only codes, so that a task that is stopped
+  (such as by a batch scheduler) doesn't lose its work
+
+If run with --checkpoint name, the code saves where it is to the file
+  name_task_id0_task_id
+  every --checkpointSeconds (default 60), and, if run again with the same options,
+  picks up from there. When the task finishes, the file is deleted.
+Like BOINC_test/upper_case.cpp, the file is written to a temporary file then renamed,
+  so the file is always either the old checkpoint or the new one.
+
+What is saved is up to the host code, which gives an array of __uint128_t,
+  such as the next pattern of the sieve file, countB, and the checksum.
+The overflow list of collatzOverflow256.h is also saved.
+The first line of the file says which code, parameters, and task it is for,
+  so the checkpoint of a different run is never used.
+The seconds printed at the end are only for the time since the last start.
+
+Usage...
+  struct checkpoint cp;
+  checkpointInit(&cp, checkpointFile, checkpointSeconds, id, task_id0, task_id);
+  if ( checkpointLoad(&cp, v, count) ) ... use v to pick up where it left off ...
+  ...
+  if ( checkpointDue(&cp) ) ... put the values in v ... checkpointSave(&cp, v, count);
+  ...
+  checkpointRemove(&cp);
+If checkpointFile is "", these do nothing.
+
+Before including this file, the host code must define print128()
+
+(c) 2021 Bradley Knockel
+
+****************************************** */
+
+
+#ifndef COLLATZCHECKPOINT_H
+#define COLLATZCHECKPOINT_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "collatzOverflow256.h"
+
+
+
+struct checkpoint {
+  char file[600];     // "" if not checkpointing
+  char tmp[610];
+  char id[512];       // which code, parameters, and task
+  int seconds;        // between checkpoints
+  time_t last;        // time of the last checkpoint
+};
+
+
+
+static void checkpointInit(struct checkpoint* cp, const char* name, const int seconds, const char* id,
+    const uint64_t task_id0, const uint64_t task_id) {
+  cp->file[0] = '\0';
+  cp->tmp[0] = '\0';
+  if ( name[0] ) {
+    snprintf(cp->file, sizeof(cp->file), "%s_%llu_%llu", name,
+        (unsigned long long)task_id0, (unsigned long long)task_id);
+    snprintf(cp->tmp, sizeof(cp->tmp), "%s.tmp", cp->file);
+  }
+  snprintf(cp->id, sizeof(cp->id), "%s", id);
+  cp->seconds = seconds;
+  cp->last = time(NULL);
+}
+
+
+
+// reads a __uint128_t written as digits, returning 0 if it worked
+static int checkpointRead128(FILE* f, __uint128_t* n) {
+  char s[48];
+  if ( fscanf(f, "%47s", s) != 1 ) return 1;
+  *n = 0;
+  for (char* p = s; *p; p++) {
+    if ( *p < '0' || *p > '9' ) return 1;
+    *n = *n * 10 + (*p - '0');
+  }
+  return 0;
+}
+
+static void checkpointWrite128(FILE* f, __uint128_t n) {
+  char a[40] = { '\0' };
+  char *p = a + 39;
+  if (n==0) { *--p = (char)('0'); }
+  else { for (; n != 0; n /= 10) *--p = (char)('0' + n % 10); }
+  fprintf(f, "%s\n", p);
+}
+
+
+
+/*
+  Returns 1 if the checkpoint was read into v[0] ... v[count - 1]
+  Returns 0 if there is no checkpoint (or it is for a different run), so start from the beginning
+*/
+static int checkpointLoad(struct checkpoint* cp, __uint128_t* v, const int count) {
+  if ( !cp->file[0] ) return 0;
+  FILE* f = fopen(cp->file, "r");
+  if (!f) return 0;
+
+  char line[sizeof(cp->id) + 2];
+  int good = fgets(line, sizeof(line), f) != NULL;
+  if (good) {
+    line[strcspn(line, "\r\n")] = '\0';
+    good = !strcmp(line, cp->id);
+  }
+  for (int i = 0; good && i < count; i++)
+    good = !checkpointRead128(f, &v[i]);
+
+  // the overflow list
+  __uint128_t n, finished;
+  good = good && !checkpointRead128(f, &n);
+  int overflows = (int)n;
+  for (int i = 0; good && i < overflows; i++) {
+    good = !checkpointRead128(f, &n) && !checkpointRead128(f, &finished);
+    if ( good && i < OVERFLOW_LIST_MAX ) {
+      overflowList[i] = n;
+      overflowListFinished[i] = (char)finished;
+    }
+  }
+  fclose(f);
+
+  if (!good) {
+    printf("  checkpoint %s is not for this run, so starting from the beginning\n", cp->file);
+    overflowListCount = 0;
+    return 0;
+  }
+  overflowListCount = overflows;
+  printf("  picking up from checkpoint %s\n", cp->file);
+  fflush(stdout);
+  return 1;
+}
+
+
+
+// returns 1 if it is time for a checkpoint
+static inline int checkpointDue(const struct checkpoint* cp) {
+  return cp->file[0] && time(NULL) - cp->last >= cp->seconds;
+}
+
+
+
+/*
+  Saves v[0] ... v[count - 1] and the overflow list
+  Returns 0 if it worked
+*/
+static int checkpointSave(struct checkpoint* cp, const __uint128_t* v, const int count) {
+  if ( !cp->file[0] ) return 0;
+  cp->last = time(NULL);
+
+  FILE* f = fopen(cp->tmp, "w");
+  if (!f) {
+    printf("  error: cannot write checkpoint %s!\n", cp->tmp);
+    return 1;
+  }
+  fprintf(f, "%s\n", cp->id);
+  for (int i = 0; i < count; i++) checkpointWrite128(f, v[i]);
+  int overflows = overflowListCount < OVERFLOW_LIST_MAX ? overflowListCount : OVERFLOW_LIST_MAX;
+  fprintf(f, "%d\n", overflows);
+  for (int i = 0; i < overflows; i++) {
+    checkpointWrite128(f, overflowList[i]);
+    fprintf(f, "%d\n", overflowListFinished[i]);
+  }
+
+  // make sure it is on the disk before the rename
+  int err = fflush(f);
+#ifdef _WIN32
+  err |= _commit(_fileno(f));
+#else
+  err |= fsync(fileno(f));
+#endif
+  err |= fclose(f);
+
+#ifdef _WIN32
+  remove(cp->file);     // rename() doesn't replace a file on Windows
+#endif
+  if ( err || rename(cp->tmp, cp->file) ) {
+    printf("  error: cannot write checkpoint %s!\n", cp->file);
+    return 1;
+  }
+  return 0;
+}
+
+
+
+// for when the task is done
+static void checkpointRemove(const struct checkpoint* cp) {
+  if ( cp->file[0] ) remove(cp->file);
+}
+
+#endif
@@ -0,0 +1,102 @@
+/* ******************************************
+
+Checksum and max n for my CPU-only codes
+
+If compiled with -DCHECKSUM, the codes add up a checksum like David Barina's
+  checksum_alpha, and they find the max n and its nStart.
+Otherwise, the CHECKSUM_ macros do nothing, so the code is just as fast as before
+  (they only use cs so that a function that just passes cs to them doesn't get a warning).
+
+The checksum is the same as in my partiallySieveless_nonNvidiaGPU/ codes...
+  "n++ n--" adds c (increases in the first k steps) then every alpha
+  "repeated k steps" adds c then k2 for every k2 steps
+So, for the same task_id0, task_id, and parameters, a CPU code and a GPU code
+  can be compared, and results from different computers can be compared,
+  which finds computers that make errors (such as from RAM without ECC).
+A number that overflows stops adding to the checksum at the overflow.
+The checksums match the GPU codes only if the GPU codes use the same 3^2 sieve
+  (my GPU codes use a 3^1 sieve). With the CPU codes changed to a 3^1 sieve,
+  the checksums in my README for partiallySieveless_nonNvidiaGPU/ are found.
+
+The max n is the largest n the code sees after the first k steps.
+For "n++ n--", this is the true max of the path (after the first k steps).
+For "repeated k steps", n is only seen every k2 steps, so it is a lower bound.
+For a number that overflows, only the n before the overflow count.
+
+The results are printed like...
+  Checksum = 8639911566
+  max n = 1234567
+  max n is for nStart = 123
+Each CPU thread needs its own struct collatzChecksum (use checksumAdd() to combine them).
+
+Before including this file, the host code must define print128()
+
+(c) 2021 Bradley Knockel
+
+****************************************** */
+
+
+#ifndef COLLATZCHECKSUM_H
+#define COLLATZCHECKSUM_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+
+
+struct collatzChecksum {
+  uint64_t checksum;
+  __uint128_t maxN;
+  __uint128_t maxNstart;    // nStart of maxN
+};
+
+
+
+#ifdef CHECKSUM
+
+#define CHECKSUM_ADD(cs, x)  ( (cs)->checksum += (x) )
+#define CHECKSUM_MAX(cs, n, nStart)  do {  \
+  if ( (n) >= (cs)->maxN ) {  \
+    if ( (n) > (cs)->maxN || (nStart) < (cs)->maxNstart ) { (cs)->maxN = (n); (cs)->maxNstart = (nStart); }  \
+  }  \
+} while (0)
+
+#else
+
+#define CHECKSUM_ADD(cs, x)  ( (void)(cs) )
+#define CHECKSUM_MAX(cs, n, nStart)  ( (void)(cs) )
+
+#endif
+
+
+
+static inline void checksumInit(struct collatzChecksum* cs) {
+  cs->checksum = 0;
+  cs->maxN = 0;
+  cs->maxNstart = 0;
+}
+
+// adds from to cs
+// For a tie in max n, the smaller nStart is kept, so the result doesn't depend on the order
+static inline void checksumAdd(struct collatzChecksum* cs, const struct collatzChecksum* from) {
+  cs->checksum += from->checksum;
+  if ( from->maxN > cs->maxN || (from->maxN == cs->maxN && from->maxNstart < cs->maxNstart) ) {
+    cs->maxN = from->maxN;
+    cs->maxNstart = from->maxNstart;
+  }
+}
+
+static void checksumPrint(const struct collatzChecksum* cs) {
+#ifdef CHECKSUM
+  printf("  Checksum = ");
+  print128(cs->checksum);
+  printf("  max n = ");
+  print128(cs->maxN);
+  printf("  max n is for nStart = ");
+  print128(cs->maxNstart);
+#else
+  (void)cs;
+#endif
+}
+
+#endif
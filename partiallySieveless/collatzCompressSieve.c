@@ -0,0 +1,289 @@
+/* ******************************************
+
+Compresses a 2^k1 sieve file made by collatzCreateSieve.c
+
+Not all 2^16 values of a 2-byte pattern are equally common.
+For k1 = 27, only 8508 distinct patterns occur, 0 is the most common,
+  and the 127 most common patterns are over half of all patterns.
+This code Huffman codes the patterns, giving common patterns short codes.
+For k1 = 27, the compressed file is 62% the size of the sieve (about 38% smaller),
+  and larger k1 (sparser sieves) compress better.
+See sieveFile.h for the details of the format.
+
+The hosts that use sieveFile.h can read the compressed file directly,
+  decoding only the part of the sieve needed by each task_id.
+Just put the name of the compressed file into the host code.
+
+Compile using something like...
+  gcc -O3 collatzCompressSieve.c
+Run using something like...
+  ./a.out sieve37 sieve37z
+Requires sieveFile.h to be in the same folder.
+
+Patterns are decoded in blocks of 2^blockLog2 patterns.
+A smaller block means less decoding is wasted when a task_id starts or ends
+  in the middle of a block, but it means more offsets must be stored.
+The 2^TASK_SIZE segment of a task_id is 2^(TASK_SIZE - 8) patterns,
+  so blockLog2 = TASK_SIZE - 8 wastes nothing.
+
+(c) 2021 Bradley Knockel
+
+****************************************** */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "sieveFile.h"
+
+
+
+// 2^blockLog2 patterns per block
+const int blockLog2 = 12;
+
+
+
+// for Huffman coding
+uint64_t freq[1 << 16];         // how often each pattern occurs
+uint32_t len[1 << 16];          // length of code of each pattern
+uint32_t code[1 << 16];         // code of each pattern
+
+
+
+int compareFreq(const void* x, const void* y) {
+  uint64_t fx = freq[*(const uint32_t*)x];
+  uint64_t fy = freq[*(const uint32_t*)y];
+  return (fx > fy) - (fx < fy);
+}
+
+int compareCanonical(const void* x, const void* y) {
+  uint32_t sx = *(const uint32_t*)x;
+  uint32_t sy = *(const uint32_t*)y;
+  if (len[sx] != len[sy]) return (len[sx] > len[sy]) - (len[sx] < len[sy]);
+  return (sx > sy) - (sx < sy);
+}
+
+
+
+/*
+  Finds the Huffman code length of each of the nSym symbols in sym[]
+  Uses the two-queue method since the leaves can be sorted by frequency.
+  Returns the longest length.
+*/
+uint32_t huffmanLengths(uint32_t* sym, uint32_t nSym, const uint64_t* f) {
+
+  if (nSym == 1) {
+    len[sym[0]] = 1;
+    return 1;
+  }
+
+  // nodes 0 to nSym-1 are leaves (sorted by frequency), the rest are internal
+  uint64_t* weight = (uint64_t*)malloc(2 * nSym * sizeof(uint64_t));
+  uint32_t* parent = (uint32_t*)malloc(2 * nSym * sizeof(uint32_t));
+  for (uint32_t i = 0; i < nSym; i++) weight[i] = f[sym[i]];
+
+  uint32_t leaf = 0;           // next unused leaf
+  uint32_t internal = nSym;    // next unused internal node
+  uint32_t next = nSym;        // next internal node to be made
+
+  for (; next < 2 * nSym - 1; next++) {
+    uint32_t pick[2];
+    for (int j = 0; j < 2; j++) {
+      if ( leaf < nSym && (internal == next || weight[leaf] <= weight[internal]) )
+        pick[j] = leaf++;
+      else
+        pick[j] = internal++;
+    }
+    weight[next] = weight[pick[0]] + weight[pick[1]];
+    parent[pick[0]] = next;
+    parent[pick[1]] = next;
+  }
+
+  // depth of each node, starting at the root (the last node)
+  uint32_t maxLen = 0;
+  uint32_t* depth = (uint32_t*)weight;   // reuse RAM
+  depth[2 * nSym - 2] = 0;
+  for (int64_t i = 2 * (int64_t)nSym - 3; i >= 0; i--) {
+    depth[i] = depth[parent[i]] + 1;
+    if (i < nSym) {
+      len[sym[i]] = depth[i];
+      if (depth[i] > maxLen) maxLen = depth[i];
+    }
+  }
+
+  free(weight);
+  free(parent);
+  return maxLen;
+}
+
+
+
+// for writing the payload one bit at a time while hashing it 8 bytes at a time
+FILE* fpOut;
+uint8_t bitByte = 0;
+int bitCount = 0;
+uint8_t hashBytes[8];
+int hashCount = 0;
+uint64_t payloadHash = SIEVEHUF_HASH_START;
+
+void writeBits(uint32_t bits, uint32_t n) {
+  while (n > 0) {
+    n--;
+    bitByte = (bitByte << 1) | ((bits >> n) & 1);
+    bitCount++;
+    if (bitCount == 8) {
+      fputc(bitByte, fpOut);
+      hashBytes[hashCount++] = bitByte;
+      if (hashCount == 8) {
+        payloadHash = sieveHufHash(payloadHash, hashBytes, 8);
+        hashCount = 0;
+      }
+      bitByte = 0;
+      bitCount = 0;
+    }
+  }
+}
+
+
+
+int main(int argc, char *argv[]) {
+
+  if( argc < 3 ) {
+    printf("Too few arguments. Aborting.\n");
+    return 0;
+  }
+
+  // get k1 from size of sieve file, which has 2^(k1 - 7) bytes
+  FILE* fp = fopen(argv[1], "rb");
+  if (!fp) {
+    printf("  error: cannot open %s!\n", argv[1]);
+    return 0;
+  }
+  sieveSeek(fp, 0, SEEK_END);
+  uint64_t bytes = sieveTell(fp);
+  fclose(fp);
+  int k1 = 7;
+  while ( ((uint64_t)1 << k1) < bytes ) k1++;
+  k1 += 7;
+  if ( bytes != ((uint64_t)1 << (k1 - 7)) || k1 - 8 < blockLog2 ) {
+    printf("  error: wrong sieve file!\n");
+    return 0;
+  }
+  printf("  k1 = %i\n", k1);
+
+  struct sieveFile sf;
+  if ( sieveOpen(&sf, argv[1], k1) ) {
+    printf("  error: wrong sieve file!\n");
+    return 0;
+  }
+  const uint64_t patterns = sf.patternCount;
+  const uint16_t* data = sieveLoad(&sf, 0, patterns);
+  if (!data) {
+    printf("  error: cannot read sieve file! Aborting.\n");
+    return 0;
+  }
+
+
+
+  /* count patterns */
+
+  for (uint64_t i = 0; i < patterns; i++) freq[data[i]]++;
+
+  uint32_t* sym = (uint32_t*)malloc((1 << 16) * sizeof(uint32_t));
+  uint32_t nSym = 0;
+  for (uint32_t s = 0; s < (1 << 16); s++) if (freq[s]) sym[nSym++] = s;
+  printf("  distinct patterns = %u\n", nSym);
+
+
+
+  /* make a canonical Huffman code */
+
+  qsort(sym, nSym, sizeof(uint32_t), compareFreq);
+
+  // If codes are too long, make rare patterns less rare until they aren't
+  uint64_t* f = (uint64_t*)malloc((1 << 16) * sizeof(uint64_t));
+  memcpy(f, freq, sizeof(freq));
+  uint32_t maxLen = huffmanLengths(sym, nSym, f);
+  while (maxLen > SIEVEHUF_MAXLEN) {
+    for (uint32_t i = 0; i < nSym; i++) f[sym[i]] = (f[sym[i]] >> 1) | 1;
+    maxLen = huffmanLengths(sym, nSym, f);
+  }
+  free(f);
+
+  struct sieveHufHeader h;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, SIEVEHUF_MAGIC, 8);
+  h.version = SIEVEHUF_VERSION;
+  h.k1 = k1;
+  h.blockLog2 = blockLog2;
+  h.maxLen = maxLen;
+  h.symbols = nSym;
+  for (uint32_t i = 0; i < nSym; i++) h.counts[len[sym[i]]]++;
+
+  // canonical order is by length then by pattern
+  qsort(sym, nSym, sizeof(uint32_t), compareCanonical);
+  uint32_t c = 0;
+  uint32_t i = 0;
+  for (uint32_t l = 1; l <= maxLen; l++) {
+    for (uint32_t j = 0; j < h.counts[l]; j++) code[sym[i++]] = c++;
+    c <<= 1;
+  }
+
+
+
+  /* find the bit offset of each block */
+
+  uint64_t blocks = patterns >> blockLog2;
+  uint64_t* offsets = (uint64_t*)malloc((blocks + 1) * sizeof(uint64_t));
+  uint64_t bit = 0;
+  for (uint64_t block = 0; block < blocks; block++) {
+    offsets[block] = bit;
+    for (uint64_t p = block << blockLog2; p < (block + 1) << blockLog2; p++) bit += len[data[p]];
+  }
+  offsets[blocks] = bit;
+
+
+
+  /* write the file */
+
+  fpOut = fopen(argv[2], "wb");
+  if (!fpOut) {
+    printf("  error: cannot open %s!\n", argv[2]);
+    return 0;
+  }
+
+  size_t symbolsStart, offsetsStart, payloadStart;
+  sieveHufLayout(&h, &symbolsStart, &offsetsStart, &payloadStart);
+
+  fwrite(&h, sizeof(h), 1, fpOut);
+  for (uint32_t j = 0; j < nSym; j++) {
+    uint16_t s = sym[j];
+    fwrite(&s, sizeof(uint16_t), 1, fpOut);
+  }
+  for (size_t j = symbolsStart + nSym * sizeof(uint16_t); j < offsetsStart; j++) fputc(0, fpOut);
+  fwrite(offsets, sizeof(uint64_t), blocks + 1, fpOut);
+
+  for (uint64_t p = 0; p < patterns; p++) writeBits(code[data[p]], len[data[p]]);
+  if (bitCount) writeBits(0, 8 - bitCount);
+
+  // now that the payload is written, write the header again with its hash
+  h.payloadHash = sieveHufHash(payloadHash, hashBytes, hashCount);
+  sieveSeek(fpOut, 0, SEEK_SET);
+  fwrite(&h, sizeof(h), 1, fpOut);
+
+  fclose(fpOut);
+
+
+
+  printf("  longest code = %u bits\n", maxLen);
+  printf("  average code = %f bits\n", (double)bit / (double)patterns);
+  printf("  compressed file is %f of the original size\n",
+      (double)(payloadStart + (bit + 7) / 8) / (double)bytes);
+
+  free(offsets);
+  free(sym);
+  sieveClose(&sf);
+  return 0;
+}
@@ -21,17 +21,31 @@ Each bit of the uint16_t will be referring to the following 16 numbers of the 25
  255
 
 Use...
-  clang -O3 collatzCreateSieve.c
+  clang -O3 -fopenmp collatzCreateSieve.c
   time ./a.out
+Without -fopenmp, a single CPU thread is used.
+Set the number of threads via the OMP_NUM_THREADS environment variable...
+  OMP_NUM_THREADS=8 ./a.out
+Requires collatzJoin.h and collatzKsteps.h to be in the same folder.
 
 Currently saves to file called "sieve"
 I change the name of the file AFTER I create it.
 
-I currently don't create a buffer before writing out.
-Should I?
-I just write two bytes at a time.
+Each 2-byte pattern can be made without knowing any other pattern,
+  so the 2^(k - 8) patterns are split into chunks of 2^20 patterns (2 MiB).
+All CPU threads work on the patterns of a chunk, then the chunk is written
+  to the end of the file using a single fwrite(), so the file is written in order.
 
-k < 41 because I use uint64_t instead of __uint128_t
+If a run is interrupted, just run it again, and it will continue from
+  the last chunk that was written.
+To know where to continue from, the progress is saved to a file
+  called "sieve_progress" after each chunk is written.
+This file is deleted once the sieve is complete.
+To start over, delete both "sieve" and "sieve_progress".
+
+k < 81 because I use __uint128_t for the numbers being tested
+However, the sieve file has 2^(k - 7) bytes, so, in practice,
+  the size of your storage drive limits k.
 
 I find the following command useful to get the first 4 2-byte patterns..
   xxd -b -l 8 sieve
@@ -44,13 +58,27 @@ I find the following command useful to get the first 4 2-byte patterns..
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <inttypes.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 
+#include "collatzJoin.h"
 
 
-// 7 < k < 41
-// k = 32 took 3 minutes to run
+
+// 7 < k < 81
+// k = 32 took 3 minutes to run on a single CPU thread
 const int k = 27;
 
+const char file[] = "sieve";                       // you might want to change filename
+const char fileProgress[] = "sieve_progress";
+const char fileProgressTemp[] = "sieve_progress_temp";
+
+// patterns in a chunk
+const uint64_t chunkPatterns = (uint64_t)1 << 20;
+
 
 
 // Prints __uint128_t numbers since printf("%llu\n", x) doesn't work
@@ -71,18 +99,55 @@ const uint8_t sieveSmall[16] = {27, 31, 47, 71, 91, 103, 111, 127, 155, 159, 167
 
 
 
-int main(void) {
+// returns the 2 bytes that store the pattern
+// jt is for the deltaN check (see collatzJoin.h), and each CPU thread has its own
+// jt->kt is for doing the k steps (see collatzKsteps.h), and all CPU threads share it
+uint16_t makePattern(uint64_t pattern, struct joinTable* jt) {
+
+  int c;
+  __uint128_t b, b0;
+  int temp;           // acts as a boolean
+  uint16_t bytes = 0;   // 2 bytes that store the pattern
 
+  for (int bit = 0; bit < 16; bit ++) {      // loop over 16 bits in pattern
 
-  FILE *file0;
-  file0 = fopen("sieve", "wb");      // you might want to change filename
+    b0 = (__uint128_t)pattern * 256 + sieveSmall[bit];
 
+    temp = 1;
 
-  int j, c, cm;
-  uint64_t b, b0, m, bm, deltaN, lenList;
-  int temp;           // acts as a boolean
-  uint16_t bytes = 0;   // 2 bytes that store the pattern
+    // check to see if 2^k*N + b0 is reduced in no more than k steps
+    //   (the steps stop once b <= b0, and b and c are then fk(b0) if not reduced)
+    if ( kstepsReduce(jt->kt, b0, b0 + 1, k, &b, &c) ) {
+      if (b==b0 && b0>1) {printf("  wow!\n");}
+      temp = 0;
+    }
 
+    // if temp=1, use another method to try to get temp=0
+    if (temp) {
+      if ( joinCheck(jt, b0, b, c) ) temp = 0;
+    }
+
+    if (temp) {
+      //bytes |= (uint16_t)1 << bit;
+      bytes += (uint16_t)1 << bit;
+    }
+
+  }
+
+  return bytes;
+}
+
+
+
+int main(void) {
+
+  int j;
+  __uint128_t deltaN;
+
+  if (k - 8 >= 64) {
+    printf("  error: the 2^(k - 8) patterns must fit in 64 bits!\n");
+    return 0;
+  }
 
   // the number of 2-byte patterns
   const uint64_t patterns  = (uint64_t)1 << (k - 8);   // 2^(k - 8)
@@ -101,13 +166,16 @@ int main(void) {
   else if (k<=37) deltaN = 88;
   else if (k<=40) deltaN = 120;
   else if (k<=43) deltaN = 208;
-  else {        // needs experimental reduction
+  else if (k<=45) deltaN = 222;
+  else if (k<=46) deltaN = 5231;  // needs experimental reduction
+  else if (k<=47) deltaN = 6015;  // needs experimental reduction
+  else {
     int minC = 0.6309297535714574371 * k + 1.0;  // add 1 to get ceiling
     double minC3 = 1.0;     // 3^minC
     for (j=0; j<minC; j++) minC3 *= 3.0;
     double deltaNtemp = 0.0;
     for (j=0; j<minC; j++) deltaNtemp = (3.0 * deltaNtemp + 1.0) / 2.0;
-    deltaNtemp = deltaNtemp * (((uint64_t)1<<k) - ((uint64_t)1<<minC)) / minC3;
+    deltaNtemp = deltaNtemp * (((__uint128_t)1<<k) - ((__uint128_t)1<<minC)) / minC3;
     deltaN = deltaNtemp + 1.0;    // add 1 to get ceiling
   }
 
@@ -116,70 +184,94 @@ int main(void) {
   print128(deltaN);
   printf("\n");
 
- 
-  for (uint64_t pattern = 0; pattern < patterns; pattern++) {
-  for (int bit = 0; bit < 16; bit ++) {      // loop over 16 bits in pattern
-
-    b0 = pattern * 256 + sieveSmall[bit];
 
-    temp = 1;
 
-    // check to see if 2^k*N + b0 is reduced in no more than k steps
-    b = b0;
-    c = 0;
-    for (j=0; j<k; j++) {  // step
-      if (b & 1) {          // bitwise test for odd
-        b = 3*(b/2) + 2;    // note that b is odd
-        c++;
-      } else {
-        b >>= 1;
-        if (b <= b0) {
-          if (b==b0 && b0>1) {printf("  wow!\n");}
-          temp = 0;
-          break;
-        }
-      }
-    }
+  /* see if a previous run was interrupted */
 
-    // if temp=1, use another method to try to get temp=0
-    if (temp) {
-      lenList = ((deltaN+1) < (b0-1)) ? (deltaN+1) : (b0-1) ;   // get min(deltaN+1, b0-1)
-      for(m=1; m<lenList; m++) {    // loop over starting numbers
-
-        bm = b0-m;
-        cm = 0;
-        // take steps to update lists
-        for(j=0; j<k; j++) {
-          if (bm & 1) {                 // bitwise test for odd
-            bm = 3*(bm/2) + 2;    // note that bm is odd
-            cm++;
-          } else {
-            bm >>= 1;
-          }
-        }
-
-        // check against original path
-        if ( bm==b && cm==c ) {
-          temp = 0;
-          break;
-        }
+  uint64_t patternStart = 0;
+  FILE *file0;
 
-      }
+  FILE *fp = fopen(fileProgress, "r");
+  if (fp) {
+    int kPrevious = 0;
+    if ( fscanf(fp, "%i %" SCNu64, &kPrevious, &patternStart) != 2 || kPrevious != k ) {
+      printf("  error: %s is not for this k!\n", fileProgress);
+      return 0;
     }
+    fclose(fp);
 
-    if (temp) {
-      //bytes |= (uint16_t)1 << bit;
-      bytes += (uint16_t)1 << bit;
+    file0 = fopen(file, "r+b");
+    if (!file0) {
+      printf("  error: cannot open %s!\n", file);
+      return 0;
+    }
+    fseeko(file0, (off_t)patternStart * sizeof(uint16_t), SEEK_SET);   // ignore any partial chunk
+
+    printf("  continuing from pattern %" PRIu64 "\n", patternStart);
+  } else {
+    file0 = fopen(file, "wb");
+    if (!file0) {
+      printf("  error: cannot open %s!\n", file);
+      return 0;
     }
-
   }
+  fflush(stdout);
+
+
 
-  fwrite(&bytes, sizeof(uint16_t), 1, file0);
-  bytes = 0;
+  /* make the sieve one chunk at a time */
 
+  uint64_t chunk = (patterns < chunkPatterns) ? patterns : chunkPatterns;
+  uint16_t* data = (uint16_t*)malloc(chunk * sizeof(uint16_t));
+
+  // lookup table for doing k steps
+  struct kstepsTable kt;
+  if ( kstepsInit(&kt, KSTEPS_BITS) ) {
+    printf("  error: cannot make the k-steps table!\n");
+    return 0;
   }
 
+  for (uint64_t chunkStart = patternStart; chunkStart < patterns; chunkStart += chunk) {
+
+#ifdef _OPENMP
+    #pragma omp parallel
+#endif
+    {
+      struct joinTable jt;
+      if ( joinInit(&jt, &kt, k, deltaN) ) {
+        printf("  error: not enough RAM for deltaN!\n");
+        exit(1);
+      }
+
+#ifdef _OPENMP
+      #pragma omp for schedule(guided)
+#endif
+      for (uint64_t i = 0; i < chunk; i++) {
+        data[i] = makePattern(chunkStart + i, &jt);
+      }
+
+      joinFree(&jt);
+    }
+
+    fwrite(data, sizeof(uint16_t), chunk, file0);
+    fflush(file0);
+#ifndef _WIN32
+    fsync(fileno(file0));    // make sure the chunk is on the drive before saving progress
+#endif
+
+    // save progress (rename() is atomic, so the progress file is never half written)
+    fp = fopen(fileProgressTemp, "w");
+    if (fp) {
+      fprintf(fp, "%i %" PRIu64 "\n", k, chunkStart + chunk);
+      fclose(fp);
+      rename(fileProgressTemp, fileProgress);
+    }
+
+  }
 
+  free(data);
+  kstepsFree(&kt);
   fclose(file0);
+  remove(fileProgress);
   return 0;
 }
@@ -0,0 +1,257 @@
+/* ******************************************
+
+Finds if a starting value n0 joins the path of n0 - m for some 1 <= m <= deltaN
+  for my CPU-only codes that make a 2^k sieve
+
+Two paths have joined after k steps if they have the same
+  fk() (the number after k steps) and the same c (the number of increases).
+The usual way is to do k steps for each of n0 - 1, n0 - 2, ... n0 - deltaN,
+  stopping at the first join, which is up to deltaN * k steps per n0.
+For large deltaN (thousands when k > 45), this is most of the time.
+
+Instead, a hash table is kept of (fk, c) for a range of recent starting values,
+  so most of the check is a single lookup.
+Each starting value in the window n0 - deltaN ... n0 - 1 is then stepped
+  at most once, no matter how many n0 have it in their window.
+The starting values must be checked in increasing order.
+
+The check for n0 is done in 3 parts...
+  1. Step the starting values newer than the table, newest first,
+       comparing each to n0 like the usual way.
+  2. Look up (fk, c) of n0 in the table.
+  3. Step the starting values older than the table, newest first,
+       comparing each to n0 like the usual way.
+This finds the smallest m, like the usual way, and it usually stops at the first join,
+  so, for a small deltaN, it does about as many k steps as the usual way.
+If part 1 stops at a join, the starting values between it and the table
+  are still stepped, since the next n0 will need them.
+If (fk, c) is in the table more than once, only the newest starting value is kept.
+When the window moves past a starting value, it is removed from the table.
+A ring buffer of the window remembers what to remove.
+
+For deltaN < JOIN_MIN_DELTAN, the windows of n0 rarely overlap,
+  and keeping the table costs more than it saves, so the usual way is used.
+
+The table has at least 2 * (deltaN + 1) slots (open addressing with linear probing),
+  so up to about 200 * (deltaN + 1) bytes of RAM are used.
+
+Usage...
+  struct joinTable jt;
+  joinInit(&jt, &kt, k, deltaN);    // kt is a kstepsTable (see collatzKsteps.h)
+  ...
+  m = joinCheck(&jt, n0, fk, c);   // 0 if no join
+  ...
+  joinFree(&jt);
+If using OpenMP, each CPU thread needs its own joinTable.
+
+(c) 2021 Bradley Knockel
+
+****************************************** */
+
+
+#ifndef COLLATZJOIN_H
+#define COLLATZJOIN_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "collatzKsteps.h"
+
+#define JOIN_MIN_DELTAN 64
+
+
+
+struct joinTable {
+  const struct kstepsTable* kt;    // for doing k steps
+  int k;
+  __uint128_t deltaN;
+
+  // the hash table (tableN[i] = 0 for an empty slot)
+  size_t tableMask;
+  __uint128_t* tableN;    // starting value
+  __uint128_t* tableB;    // its fk()
+  int* tableC;            // its c
+
+  // ring buffer of the window, indexed by the low bits of the starting value
+  size_t ringMask;
+  __uint128_t* ringB;
+  int* ringC;
+
+  // the table has the starting values oldest <= n < next
+  __uint128_t oldest;
+  __uint128_t next;
+};
+
+
+
+static inline size_t joinHash(const struct joinTable* jt, __uint128_t b, int c) {
+  uint64_t h = (uint64_t)b ^ (uint64_t)(b >> 64) ^ ((uint64_t)c << 57);
+  h *= 0x9e3779b97f4a7c15;
+  return (size_t)(h >> 32) & jt->tableMask;
+}
+
+
+
+// returns 0 if it worked
+static int joinInit(struct joinTable* jt, const struct kstepsTable* kt, int k, __uint128_t deltaN) {
+
+  size_t ring = 1;
+  while ( ring < deltaN + 1 ) ring <<= 1;
+
+  jt->kt = kt;
+  jt->k = k;
+  jt->deltaN = deltaN;
+  jt->tableMask = 2*ring - 1;
+  jt->ringMask = ring - 1;
+  jt->tableN = (__uint128_t*)calloc(2*ring, sizeof(__uint128_t));
+  jt->tableB = (__uint128_t*)malloc(2*ring*sizeof(__uint128_t));
+  jt->tableC = (int*)malloc(2*ring*sizeof(int));
+  jt->ringB = (__uint128_t*)malloc(ring*sizeof(__uint128_t));
+  jt->ringC = (int*)malloc(ring*sizeof(int));
+  jt->oldest = 0;
+  jt->next = 0;
+
+  return !jt->tableN || !jt->tableB || !jt->tableC || !jt->ringB || !jt->ringC;
+}
+
+static void joinFree(struct joinTable* jt) {
+  free(jt->tableN);
+  free(jt->tableB);
+  free(jt->tableC);
+  free(jt->ringB);
+  free(jt->ringC);
+}
+
+
+
+// adds starting value n with fk(n) = b and c, unless a newer n has the same b and c
+static inline void joinAdd(struct joinTable* jt, __uint128_t n, __uint128_t b, int c) {
+
+  jt->ringB[(size_t)n & jt->ringMask] = b;
+  jt->ringC[(size_t)n & jt->ringMask] = c;
+
+  size_t i = joinHash(jt, b, c);
+  while ( jt->tableN[i] && (jt->tableB[i] != b || jt->tableC[i] != c) )
+    i = (i + 1) & jt->tableMask;
+  if ( jt->tableN[i] > n ) return;
+  jt->tableN[i] = n;
+  jt->tableB[i] = b;
+  jt->tableC[i] = c;
+}
+
+
+
+// removes starting value n (if a newer n has its b and c, there is nothing to do)
+static inline void joinRemove(struct joinTable* jt, __uint128_t n) {
+
+  const __uint128_t b = jt->ringB[(size_t)n & jt->ringMask];
+  const int c = jt->ringC[(size_t)n & jt->ringMask];
+
+  size_t i = joinHash(jt, b, c);
+  while ( jt->tableN[i] && (jt->tableB[i] != b || jt->tableC[i] != c) )
+    i = (i + 1) & jt->tableMask;
+  if ( jt->tableN[i] != n ) return;
+
+  // move later entries back so that no lookup stops early at the empty slot
+  size_t empty = i;
+  jt->tableN[empty] = 0;
+  for (i = (i + 1) & jt->tableMask; jt->tableN[i]; i = (i + 1) & jt->tableMask) {
+    size_t home = joinHash(jt, jt->tableB[i], jt->tableC[i]);
+    if ( ((i - home) & jt->tableMask) < ((i - empty) & jt->tableMask) ) continue;
+    jt->tableN[empty] = jt->tableN[i];
+    jt->tableB[empty] = jt->tableB[i];
+    jt->tableC[empty] = jt->tableC[i];
+    jt->tableN[i] = 0;
+    empty = i;
+  }
+}
+
+static inline void joinRemoveAll(struct joinTable* jt) {
+  for (; jt->oldest < jt->next; jt->oldest++) joinRemove(jt, jt->oldest);
+}
+
+
+
+/*
+  Returns the smallest 1 <= m <= deltaN such that n0 - m >= 2 has the same
+    fk() and c as n0, or 0 if there is none
+  b = fk(n0), and c is its number of increases
+  n0 is then added to the table
+*/
+static inline __uint128_t joinCheck(struct joinTable* jt, __uint128_t n0, __uint128_t b, int c) {
+
+  // lowest starting value of the window
+  const __uint128_t lo = (n0 > jt->deltaN + 2) ? n0 - jt->deltaN : 2;
+
+  __uint128_t m = 0;
+  __uint128_t n;
+  int cn;
+
+  // the usual way
+  if ( jt->deltaN < JOIN_MIN_DELTAN ) {
+    for (n = n0; n > lo; ) {
+      n--;
+      if ( kstepsFull(jt->kt, n, jt->k, &cn) == b && cn == c ) return n0 - n;
+    }
+    return 0;
+  }
+
+  // remove what is not in the window
+  if ( n0 < jt->next || jt->next <= lo ) {
+    joinRemoveAll(jt);
+    jt->oldest = lo;
+    jt->next = lo;
+  }
+  for (; jt->oldest < lo; jt->oldest++) joinRemove(jt, jt->oldest);
+
+  // 1. the starting values newer than the table
+  for (n = n0; n > jt->next; ) {
+    n--;
+    __uint128_t bn = kstepsFull(jt->kt, n, jt->k, &cn);
+    joinAdd(jt, n, bn, cn);
+    if ( bn == b && cn == c ) {
+      m = n0 - n;
+      break;
+    }
+  }
+  if ( m && n > jt->next ) {   // the table and the newer values don't touch
+    if ( jt->oldest < jt->next ) {
+      // the gap is in the window of the next n0 too, so fill it
+      while ( n > jt->next ) {
+        n--;
+        __uint128_t bn = kstepsFull(jt->kt, n, jt->k, &cn);
+        joinAdd(jt, n, bn, cn);
+      }
+    } else {
+      jt->oldest = n;    // the table was empty
+    }
+  }
+  jt->next = n0;
+
+  // 2. the table
+  if ( !m ) {
+    size_t i = joinHash(jt, b, c);
+    while ( jt->tableN[i] ) {
+      if ( jt->tableB[i] == b && jt->tableC[i] == c ) {
+        m = n0 - jt->tableN[i];
+        break;
+      }
+      i = (i + 1) & jt->tableMask;
+    }
+  }
+
+  // 3. the starting values older than the table
+  while ( !m && jt->oldest > lo ) {
+    n = jt->oldest - 1;
+    __uint128_t bn = kstepsFull(jt->kt, n, jt->k, &cn);
+    if ( bn == b && cn == c ) m = n0 - n;
+    joinAdd(jt, n, bn, cn);
+    jt->oldest = n;
+  }
+
+  joinAdd(jt, n0, b, c);
+  jt->next = n0 + 1;
+  return m;
+}
+
+#endif
@@ -0,0 +1,223 @@
+/* ******************************************
+
+Writes one JSON line per task for my CPU-only codes
+
+The usual output is for people to read. For many thousands of tasks,
+  parsing it is slow and fragile, so, if run with --json file,
+  my CPU codes also append one line to file for each task, such as...
+  {"code":"sieveless_npp","k":35,"k1":-1,"k2":-1,"deltaN":46,"MOD3_POWER":2,...}
+See collatzAggregate.py (in the main folder) to combine these files.
+
+Every line has code, k, k1, k2, deltaN, MOD3_POWER, TASK_SIZE, and TASK_SIZE0,
+  with -1 for the ones a code doesn't have (such as k1 for the sieveless codes),
+  since tasks can only be compared or added up if these are all the same.
+
+128-bit integers (and anything that might not fit in a double) are written
+  as strings of digits, since JSON numbers are usually read as doubles.
+
+Each line is made in memory, then appended by a single write() to a file opened with O_APPEND,
+  so many processes can append to the same file on Linux and macOS,
+  even when a long overflow_list makes a line larger than the stdio buffer.
+On Windows, fputs() is used instead, so give each process its own file
+  (collatzCoordinator.py already does).
+
+Usage...
+  struct jsonRecord j;
+  jsonStart(&j);
+  jsonString(&j, "code", "sieveless_npp");
+  jsonInt(&j, "k", k);
+  jsonU128(&j, "countB", countB);
+  jsonWrite(&j, jsonFile);
+
+jsonChecksum() is only here if collatzChecksum.h is included first,
+  and jsonOverflows() is only here if collatzOverflow256.h is included first,
+  so that codes without these (such as in ../reduceTo1/) can still use this file.
+
+(c) 2021 Bradley Knockel
+
+****************************************** */
+
+
+#ifndef COLLATZJSON_H
+#define COLLATZJSON_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+
+struct jsonRecord {
+  char* s;
+  size_t len;
+  size_t size;
+  int error;     // 1 if out of RAM
+};
+
+
+
+// appends to the line like printf()
+static void jsonAdd(struct jsonRecord* j, const char* format, ...) {
+  if (j->error) return;
+  while (1) {
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(j->s + j->len, j->size - j->len, format, args);
+    va_end(args);
+    if (n < 0) { j->error = 1; return; }
+    if ( j->len + n < j->size ) { j->len += n; return; }
+    size_t size = 2*j->size + n;
+    char* s = (char*)realloc(j->s, size);
+    if (!s) { j->error = 1; return; }
+    j->s = s;
+    j->size = size;
+  }
+}
+
+// writes "name": with a comma if needed
+static void jsonKey(struct jsonRecord* j, const char* name) {
+  char last = j->len ? j->s[j->len - 1] : '{';
+  jsonAdd(j, (last == '{' || last == '[') ? "\"%s\":" : ",\"%s\":", name);
+}
+
+
+
+static void jsonStart(struct jsonRecord* j) {
+  j->size = 1024;
+  j->len = 0;
+  j->s = (char*)malloc(j->size);
+  j->error = !j->s;
+  if (j->s) j->s[0] = '\0';
+  jsonAdd(j, "{");
+}
+
+static void jsonInt(struct jsonRecord* j, const char* name, long long v) {
+  jsonKey(j, name);
+  jsonAdd(j, "%lld", v);
+}
+
+static void jsonDouble(struct jsonRecord* j, const char* name, double v) {
+  jsonKey(j, name);
+  jsonAdd(j, "%.6e", v);
+}
+
+// escapes " and \ (such as in a Windows path) and control characters
+static void jsonString(struct jsonRecord* j, const char* name, const char* v) {
+  jsonKey(j, name);
+  jsonAdd(j, "\"");
+  for (; *v; v++) {
+    unsigned char ch = (unsigned char)*v;
+    if (ch == '"' || ch == '\\') jsonAdd(j, "\\%c", ch);
+    else if (ch < 0x20) jsonAdd(j, "\\u%04x", ch);
+    else jsonAdd(j, "%c", ch);
+  }
+  jsonAdd(j, "\"");
+}
+
+// like print128() but as a JSON string
+static void jsonU128(struct jsonRecord* j, const char* name, __uint128_t n) {
+  char a[40] = { '\0' };
+  char *p = a + 39;
+  if (n==0) { *--p = (char)('0'); }
+  else { for (; n != 0; n /= 10) *--p = (char)('0' + n % 10); }
+  jsonString(j, name, p);
+}
+
+
+
+#ifdef COLLATZCHECKSUM_H
+
+// the checksum and max n, only if compiled with -DCHECKSUM (see collatzChecksum.h)
+static void jsonChecksum(struct jsonRecord* j, const struct collatzChecksum* cs) {
+#ifdef CHECKSUM
+  jsonU128(j, "checksum", cs->checksum);
+  jsonU128(j, "max_n", cs->maxN);
+  jsonU128(j, "max_n_nStart", cs->maxNstart);
+#else
+  (void)j;
+  (void)cs;
+#endif
+}
+
+#endif
+
+
+
+#ifdef COLLATZOVERFLOW256_H
+
+/*
+  The overflows (see collatzOverflow256.h) that have bLo <= (nStart % 2^k) < bHi
+    and aLo <= (nStart >> k) < aHi, where these are for the task, then how many there are
+  "finished" is true if 256 bits were enough
+  The list is only so long, so the codes that count overflows also write
+    "overflow_count", which is how many times they counted 128 bits not being enough
+*/
+static void jsonOverflows(struct jsonRecord* j, const int k, const __uint128_t bLo, const __uint128_t bHi,
+    const __uint128_t aLo, const __uint128_t aHi) {
+  const __uint128_t mask = ((__uint128_t)1 << k) - 1;
+  int count = 0;
+  jsonKey(j, "overflow_list");
+  jsonAdd(j, "[");
+  for (int i = 0; i < overflowListCount && i < OVERFLOW_LIST_MAX; i++) {
+    __uint128_t b = overflowList[i] & mask;
+    __uint128_t a = overflowList[i] >> k;
+    if ( b < bLo || b >= bHi || a < aLo || a >= aHi ) continue;
+    jsonAdd(j, count ? ",{" : "{");
+    jsonU128(j, "nStart", overflowList[i]);
+    jsonKey(j, "finished");
+    jsonAdd(j, overflowListFinished[i] ? "true}" : "false}");
+    count++;
+  }
+  jsonAdd(j, "]");
+  jsonInt(j, "overflows", count);
+  if ( overflowListCount > OVERFLOW_LIST_MAX ) jsonInt(j, "overflow_list_full", 1);
+}
+
+#endif
+
+
+
+/*
+  Ends the line, appends it to the file, and frees it
+  Returns 0 if it worked
+*/
+static int jsonWrite(struct jsonRecord* j, const char* filename) {
+
+  jsonAdd(j, "}\n");
+  int err = j->error;
+
+  if (!err) {
+#ifndef _WIN32
+    // one write() so that lines from other processes can't end up inside this one
+    int fd = open(filename, O_WRONLY | O_APPEND | O_CREAT, 0644);
+    if (fd >= 0) {
+      if ( write(fd, j->s, j->len) != (ssize_t)j->len ) err = 1;
+      if ( close(fd) ) err = 1;
+    } else {
+      err = 1;
+    }
+#else
+    FILE* fp = fopen(filename, "a");
+    if (fp) {
+      if ( fputs(j->s, fp) < 0 ) err = 1;
+      if ( fclose(fp) ) err = 1;
+    } else {
+      err = 1;
+    }
+#endif
+  }
+  if (err) printf("  error: cannot write to %s!\n", filename);
+
+  free(j->s);
+  j->s = NULL;
+  return err;
+}
+
+#endif
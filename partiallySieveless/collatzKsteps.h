@@ -0,0 +1,210 @@
+/* ******************************************
+
+Does the first k steps of a starting value b for my CPU-only codes that make a sieve,
+  s steps at a time using a lookup table, instead of 1 step at a time
+
+This is the same idea as arrayk2 in my "repeated k steps" codes.
+Write x = q * 2^s + r, where r is the lowest s bits of x.
+After s steps, x becomes 3^c * q + d, where c and d only depend on r.
+step[r] = d + (c << 58), just like arrayk2.
+
+While making a sieve, the steps must stop as soon as the number drops below b.
+After i <= s steps, x becomes A_i * q + B_i, where A_i = 3^c_i * 2^(s - i),
+  and B_i only depends on r.
+Since these are lines in q, the line with the smallest A_i (minA[r] and minB[r])
+  gives the smallest number once q >= minQ[r], which is computed from the lines.
+So, for q >= minQ[r], checking minA[r] * q + minB[r] against b
+  checks all s steps at once!
+If this number is less than b, or if q < minQ[r],
+  the s steps are done one at a time to find exactly where the steps stop.
+Most b are ruled out in their first few steps, which are still done one at a time,
+  so the table mostly speeds up the b that need many steps
+  and the k steps of the deltaN check.
+
+kstepsReduce() does the k steps for the reduction test, and
+  kstepsFull() does all k steps without checking (for the deltaN check).
+The results are exactly the same as doing 1 step at a time.
+
+Usage...
+  struct kstepsTable kt;
+  kstepsInit(&kt, KSTEPS_BITS);
+  ...
+  int stop = kstepsReduce(&kt, b, b, k, &bb, &c);   // 0 if not reduced
+  ...
+  kstepsFree(&kt);
+The table is only read, so CPU threads can share it.
+
+(c) 2021 Bradley Knockel
+
+****************************************** */
+
+
+#ifndef COLLATZKSTEPS_H
+#define COLLATZKSTEPS_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+// s = 10 was fastest on my CPU (the table is then 28 KiB)
+#define KSTEPS_BITS 10
+
+
+
+struct kstepsTable {
+  int s;
+  uint64_t* step;      // d + (c << 58) for s steps
+  uint32_t* minQ;      // the line with the smallest A_i is the lowest for q >= minQ
+  uint64_t* minA;      // the smallest A_i
+  uint64_t* minB;      // B_i of that line
+  uint64_t pow3[17];   // 3^c
+};
+
+
+
+// returns 0 if it worked
+static int kstepsInit(struct kstepsTable* t, int s) {
+
+  if ( s < 2 || s > 16 ) return 1;   // 3^16 * 2^16 < 2^58 so A_i and B_i fit
+
+  const uint32_t size = (uint32_t)1 << s;
+  t->s = s;
+  t->step = (uint64_t*)malloc(size * sizeof(uint64_t));
+  t->minQ = (uint32_t*)malloc(size * sizeof(uint32_t));
+  t->minA = (uint64_t*)malloc(size * sizeof(uint64_t));
+  t->minB = (uint64_t*)malloc(size * sizeof(uint64_t));
+  if ( !t->step || !t->minQ || !t->minA || !t->minB ) return 1;
+
+  t->pow3[0] = 1;
+  for (int i = 1; i <= s; i++) t->pow3[i] = 3*t->pow3[i-1];
+
+  uint64_t lineA[17], lineB[17];
+
+  for (uint32_t r = 0; r < size; r++) {
+
+    // x = A*q + B, starting with A = 2^s and B = r
+    uint64_t A = size;
+    uint64_t B = r;
+    int c = 0;
+    int best = 1;
+    for (int i = 1; i <= s; i++) {
+      if (B & 1) {       // A is even, so x has the parity of B
+        A = 3*(A/2);
+        B = 3*(B/2) + 2;
+        c++;
+      } else {
+        A >>= 1;
+        B >>= 1;
+      }
+      lineA[i] = A;
+      lineB[i] = B;
+      if ( A < lineA[best] ) best = i;
+    }
+    t->step[r] = B + ((uint64_t)c << 58);
+
+    // smallest q such that line best is the lowest line
+    uint64_t q = 0;
+    for (int i = 1; i <= s; i++) {
+      if ( i == best || lineB[i] >= lineB[best] ) continue;
+      uint64_t dA = lineA[i] - lineA[best];      // > 0 since no two A_i are equal
+      uint64_t need = (lineB[best] - lineB[i] + dA - 1) / dA;
+      if ( need > q ) q = need;
+    }
+
+    t->minQ[r] = (q > UINT32_MAX) ? UINT32_MAX : (uint32_t)q;
+    t->minA[r] = lineA[best];
+    t->minB[r] = lineB[best];
+  }
+
+  return 0;
+}
+
+static void kstepsFree(struct kstepsTable* t) {
+  free(t->step);
+  free(t->minQ);
+  free(t->minA);
+  free(t->minB);
+}
+
+
+
+// k steps of n (with no checking), giving fk(n) and c
+static inline __uint128_t kstepsFull(const struct kstepsTable* t, __uint128_t n, int k, int* c) {
+
+  const int s = t->s;
+  const uint64_t mask = ((uint64_t)1 << s) - 1;
+  int j = 0;
+  *c = 0;
+
+  for (; j + s <= k; j += s) {
+    uint64_t newB = t->step[(uint64_t)n & mask];
+    int newC = newB >> 58;
+    n = (n >> s) * t->pow3[newC] + (newB & 0x3ffffffffffffff);
+    *c += newC;
+  }
+
+  for (; j < k; j++) {
+    if (n & 1) {
+      n = 3*(n/2) + 2;    // note that n is odd
+      (*c)++;
+    } else {
+      n >>= 1;
+    }
+  }
+
+  return n;
+}
+
+
+
+/*
+  k steps of b, stopping after the first step that makes the number less than lim
+  Returns how many steps were done if it stopped, or 0 if it did all k steps
+  bb and c are the number and the number of increases when it stopped
+  Use lim = b to test if 2^k*N + b is reduced in no more than k steps
+*/
+static inline int kstepsReduce(const struct kstepsTable* t, __uint128_t b, __uint128_t lim,
+    int k, __uint128_t* bb, int* c) {
+
+  const int s = t->s;
+  const uint64_t mask = ((uint64_t)1 << s) - 1;
+  __uint128_t x = b;
+  int cx = 0;
+  int j = 0;
+
+  for (; j < k; j += s) {
+
+    const int n = (k - j < s) ? k - j : s;    // steps in this block
+    const uint64_t r = (uint64_t)x & mask;
+    const __uint128_t q = x >> s;
+
+    // s steps at once if none of them can make x less than lim
+    if ( n == s && q >= t->minQ[r] && q * t->minA[r] + t->minB[r] >= lim ) {
+      uint64_t newB = t->step[r];
+      int newC = newB >> 58;
+      x = q * t->pow3[newC] + (newB & 0x3ffffffffffffff);
+      cx += newC;
+      continue;
+    }
+
+    // else 1 step at a time
+    for (int i = 1; i <= n; i++) {
+      if (x & 1) {
+        x = 3*(x/2) + 2;    // note that x is odd
+        cx++;
+      } else {
+        x >>= 1;
+        if (x < lim) {
+          *bb = x;
+          *c = cx;
+          return j + i;
+        }
+      }
+    }
+  }
+
+  *bb = x;
+  *c = cx;
+  return 0;
+}
+
+#endif
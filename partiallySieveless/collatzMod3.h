@@ -0,0 +1,184 @@
+/* ******************************************
+
+Skips the a that are excluded by a 3^m sieve for my CPU-only codes
+
+For n = a*2^k + b, my codes test each aStart <= a < aEnd for a b that needs testing,
+  and the 3^2 sieve excludes the n with n%9 being 2, 4, 5, or 8.
+This was done by finding n%9 for every a then using continue,
+  so a modulo and a branch were done for every a, including the 4/9 of them that are excluded.
+Since n%9 for a+1 is (n%9 + 2^k%9)%9, the a that aren't excluded repeat every 9 a.
+So, knowing n%9 of an a that isn't excluded, a lookup table can give
+  how many a until the next one that isn't excluded, and n%9 for that a.
+The modulo is then only done once for each b, and every a of the loop is tested.
+
+Any 3^m can be used by compiling with -DMOD3_POWER=m for 0 <= m <= 9 (the default is 2).
+m = 0 is no 3^m sieve, and m = 1 is the 3^1 sieve.
+For each n%3^m, mod3Init() looks for a smaller number that reaches n
+  by going backwards from n = 3^m N + r...
+    n came from 2n
+    n came from (2n - 1)/3 if it is an odd integer for every N
+  until it finds x = A N + r' with A < 3^m and r' < r.
+For m = 2, this finds the usual 2, 4, 5, and 8.
+As the README says, larger m only excludes a few percent more n
+  (m = 9 excludes 46.5% instead of 44.4%).
+Since the a that aren't excluded are now found by a lookup, larger m costs no more for each a,
+  but the tables have 3^m entries (19683 for m = 9), and they then don't stay in L1 cache.
+On my CPU, m = 2 made the repeatedKsteps code about 10% faster than doing a modulo for each a,
+  and m = 9 was no faster than m = 2 (and was slower when using SIMD lanes).
+Note that the checksum (see collatzChecksum.h) depends on m,
+  so don't mix tasks run with different m.
+
+Usage...
+  struct mod3Sieve m3;
+  mod3Init(&m3, k);   // once
+  ...
+  a = aStart;
+  int nMod = mod3First(&m3, &a, b);
+  for (; a < aEnd; a += m3.skip[nMod], nMod = m3.next[nMod]) {
+    ... test n = a*2^k + b ...
+  }
+
+Works for C and C++
+
+(c) 2021 Bradley Knockel
+
+****************************************** */
+
+
+#ifndef COLLATZMOD3_H
+#define COLLATZMOD3_H
+
+#include <stdint.h>
+#include <string.h>
+
+#ifndef MOD3_POWER
+#define MOD3_POWER 2
+#endif
+
+#if MOD3_POWER < 0 || MOD3_POWER > 9
+#error "MOD3_POWER must be 0 to 9"
+#endif
+
+// 3^m
+#if MOD3_POWER == 0
+#define MOD3_NUM 1
+#elif MOD3_POWER == 1
+#define MOD3_NUM 3
+#elif MOD3_POWER == 2
+#define MOD3_NUM 9
+#elif MOD3_POWER == 3
+#define MOD3_NUM 27
+#elif MOD3_POWER == 4
+#define MOD3_NUM 81
+#elif MOD3_POWER == 5
+#define MOD3_NUM 243
+#elif MOD3_POWER == 6
+#define MOD3_NUM 729
+#elif MOD3_POWER == 7
+#define MOD3_NUM 2187
+#elif MOD3_POWER == 8
+#define MOD3_NUM 6561
+#else
+#define MOD3_NUM 19683
+#endif
+
+
+
+struct mod3Sieve {
+  int kkMod;                      // 2^k % 3^m
+  int excludedCount;
+  uint8_t excluded[MOD3_NUM];     // 1 if n%3^m is excluded
+  uint16_t skip[MOD3_NUM];        // for n%3^m of an a, how many a until the next that isn't excluded
+  uint16_t next[MOD3_NUM];        // n%3^m of that a
+};
+
+
+
+// x % 3^m
+static inline int mod3Of(const __uint128_t x) {
+  const uint64_t M = MOD3_NUM;
+  const uint64_t two64Mod = (uint64_t)( ((__uint128_t)1 << 64) % M );
+  return (int)( ( (uint64_t)x % M + ((uint64_t)(x >> 64) % M) * two64Mod ) % M );
+}
+
+
+
+/*
+  Returns 1 if some x = A N + r' with A < 3^m and r' < r0 reaches A0 N + r0,
+    where A = 2^i 3^e and A0 = 3^m
+  Going backwards, each step multiplies A by 2 or by 2/3,
+    so A can only get below 3^m if A 2^e < 3^(m+e)
+*/
+static int mod3Reaches(const uint64_t A, const int e, const uint64_t r, const uint64_t r0) {
+
+  uint64_t limit = MOD3_NUM;    // 3^(m+e) / 2^e
+  for (int j = 0; j < e; j++) limit *= 3;
+  if ( (A << e) >= limit ) return 0;
+
+  if ( A < MOD3_NUM && r < r0 ) return 1;
+
+  // came from (2n - 1)/3, which must be odd
+  if ( e > 0 && r > 0 && (2*r - 1) % 3 == 0 && ((2*r - 1) / 3) & 1 ) {
+    if ( mod3Reaches(2*A/3, e - 1, (2*r - 1)/3, r0) ) return 1;
+  }
+
+  // came from 2n
+  return mod3Reaches(2*A, e, 2*r, r0);
+}
+
+
+
+// makes the tables for k
+static void mod3Init(struct mod3Sieve* m3, const int k) {
+  memset(m3, 0, sizeof(*m3));
+  m3->kkMod = mod3Of((__uint128_t)1 << k);
+
+  for (int r = 0; r < MOD3_NUM; r++) {
+    m3->excluded[r] = (uint8_t)mod3Reaches(MOD3_NUM, MOD3_POWER, r, r);
+    m3->excludedCount += m3->excluded[r];
+  }
+
+  // 2^k is not a multiple of 3, so n%3^m goes through every value as a goes through 3^m values
+  for (int r = 0; r < MOD3_NUM; r++) {
+    int d = 1;
+    int s = (r + m3->kkMod) % MOD3_NUM;
+    while ( m3->excluded[s] ) {
+      d++;
+      s = (s + m3->kkMod) % MOD3_NUM;
+    }
+    m3->skip[r] = (uint16_t)d;
+    m3->next[r] = (uint16_t)s;
+  }
+}
+
+
+
+// moves a to the first a >= a whose n = a*2^k + b isn't excluded, returning n%3^m of it
+static inline int mod3First(const struct mod3Sieve* m3, __uint128_t* a, const __uint128_t b) {
+  int nMod = ( mod3Of(*a) * m3->kkMod + mod3Of(b) ) % MOD3_NUM;
+  if ( m3->excluded[nMod] ) {
+    *a += m3->skip[nMod];
+    nMod = m3->next[nMod];
+  }
+  return nMod;
+}
+
+
+
+/*
+  How many aStart <= a < aEnd have n = a*2^k + b that aren't excluded
+  Every 3^m a in a row have 3^m - excludedCount of them,
+    so only the last (aEnd - aStart) % 3^m a are gone through
+*/
+static inline __uint128_t mod3Count(const struct mod3Sieve* m3, const __uint128_t aStart, const __uint128_t aEnd,
+    const __uint128_t b) {
+  const __uint128_t aSteps = aEnd - aStart;
+  __uint128_t count = aSteps / MOD3_NUM * (MOD3_NUM - m3->excludedCount);
+  __uint128_t a = aEnd - aSteps % MOD3_NUM;
+  if (a == aEnd) return count;
+  int nMod = mod3First(m3, &a, b);
+  for (; a < aEnd; a += m3->skip[nMod], nMod = m3->next[nMod]) count++;
+  return count;
+}
+
+#endif
@@ -0,0 +1,105 @@
+/* ******************************************
+
+Finishes numbers that overflow 128 bits for my CPU-only codes
+  by running them again using 256-bit integers
+
+When the 128-bit code finds that nStart will overflow, it calls overflow256(),
+  which does the path of nStart again using 4 limbs of 64 bits
+  until the number is less than nStart.
+Overflow is very rare, so this is only a tiny amount of time,
+  and the usual 128-bit code stays exactly the same.
+
+The steps are done bits at a time using a table like arrayk2,
+  where table[r] = d + (c << 58)
+  (the "repeated k steps" codes use arrayk2, and the "n++ n--" codes use
+  the step table of collatzKsteps.h).
+So that 3^c fits in 64 bits, bits <= 40 is required.
+
+If the number drops below nStart, the following is printed...
+  Overflow! 256 bits were enough for nStart = 274133054632352106267
+and the number doesn't need to be checked by collatzTestOverflow.py.
+If even 256 bits isn't enough, the usual message is printed...
+  Overflow! nStart = 274133054632352106267
+and this number must be carefully checked (see collatzTestOverflow.c).
+
+Before including this file, the host code must define print128()
+
+(c) 2021 Bradley Knockel
+
+****************************************** */
+
+
+#ifndef COLLATZOVERFLOW256_H
+#define COLLATZOVERFLOW256_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+
+
+/*
+  Returns 1 if nStart drops below itself using 256-bit integers,
+    or 0 if the number gets larger than 256 bits
+*/
+static int collatz256(const __uint128_t nStart, const uint64_t* table, const int bits) {
+
+  uint64_t pow3[41];     // 3^c
+  pow3[0] = 1;
+  for (int i = 1; i <= bits; i++) pow3[i] = 3*pow3[i-1];
+
+  const uint64_t mask = ((uint64_t)1 << bits) - 1;
+  uint64_t n[4] = {(uint64_t)nStart, (uint64_t)(nStart >> 64), 0, 0};   // n[0] is the lowest 64 bits
+
+  while (1) {
+    uint64_t newB = table[n[0] & mask];
+    int newC = newB >> 58;       // just 6 bits gives c
+    newB &= 0x3ffffffffffffff;   // rest of bits gives b
+
+    // n >>= bits
+    for (int i = 0; i < 3; i++) n[i] = (n[i] >> bits) | (n[i+1] << (64 - bits));
+    n[3] >>= bits;
+
+    // n = n*3^newC + newB
+    __uint128_t carry = newB;
+    for (int i = 0; i < 4; i++) {
+      carry += (__uint128_t)n[i] * pow3[newC];
+      n[i] = (uint64_t)carry;
+      carry >>= 64;
+    }
+    if (carry) return 0;
+
+    if ( !(n[2] | n[3]) && ( ((__uint128_t)n[1] << 64) | n[0] ) < nStart ) return 1;
+  }
+}
+
+
+
+/*
+  The overflows are also kept for --json (see collatzJson.h)
+  overflowListCount can be more than OVERFLOW_LIST_MAX
+*/
+#define OVERFLOW_LIST_MAX 1024
+static __uint128_t overflowList[OVERFLOW_LIST_MAX];
+static char overflowListFinished[OVERFLOW_LIST_MAX];   // 1 if 256 bits were enough
+static int overflowListCount = 0;
+
+
+
+// for when nStart overflows 128 bits
+// If called by many threads, call from inside an omp critical
+static void overflow256(const __uint128_t nStart, const uint64_t* table, const int bits) {
+  int finished = collatz256(nStart, table, bits);
+  if ( finished )
+    printf("Overflow! 256 bits were enough for nStart = ");
+  else
+    printf("Overflow! nStart = ");
+  print128(nStart);
+
+  if ( overflowListCount < OVERFLOW_LIST_MAX ) {
+    overflowList[overflowListCount] = nStart;
+    overflowListFinished[overflowListCount] = (char)finished;
+  }
+  overflowListCount++;
+}
+
+#endif
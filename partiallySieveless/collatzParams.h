@@ -0,0 +1,205 @@
+/* ******************************************
+
+Lets my CPU hosts change k, k1, k2, TASK_SIZE, TASK_SIZE0,
+  and the sieve file without recompiling
+
+The values written in the host code are the defaults.
+To change them, use options before or after the usual arguments...
+  ./a.out --k 51 --k2 13 --TASK_SIZE 20 --TASK_SIZE0 67  task_id0  task_id
+  ./a.out --sieve=sieve40 --k1=40  task_id0  task_id
+or put them in a config file, one per line...
+  # my machine
+  k2 = 13
+  TASK_SIZE = 20
+then use...
+  ./a.out --config myConfig  task_id0  task_id
+Options after --config override the config file.
+Don't change any of these values between runs of the same search!
+
+paramsCheck() checks all the rules that the host codes need,
+  so that a typo doesn't silently run the wrong numbers.
+A code that only wants the options (such as ../collatzTestOverflow.c)
+  can define PARAMS_NO_CHECK before including this file to leave out paramsCheck().
+
+Works in C and C++
+
+(c) 2021 Bradley Knockel
+
+****************************************** */
+
+
+#ifndef COLLATZPARAMS_H
+#define COLLATZPARAMS_H
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+
+
+
+/*
+  An option that can be set
+  For an int, intValue points to it
+  For a string, strValue points to it, and strSize is its size
+*/
+struct collatzParam {
+  const char* name;
+  int* intValue;
+  char* strValue;
+  size_t strSize;
+};
+
+
+
+// sets the option called name, returning 0 if it worked
+static int paramsSet(struct collatzParam* params, const char* name, const char* value) {
+
+  for (struct collatzParam* p = params; p->name; p++) {
+    if (strcmp(p->name, name)) continue;
+
+    if (p->intValue) {
+      // a value that doesn't fit in an int is an error instead of becoming some other int
+      char* end;
+      errno = 0;
+      long v = strtol(value, &end, 10);
+      if (end == value || *end != '\0' || errno == ERANGE || v < INT_MIN || v > INT_MAX) {
+        printf("  error: %s must be an integer!\n", name);
+        return 1;
+      }
+      *p->intValue = (int)v;
+    } else {
+      if (strlen(value) >= p->strSize) {
+        printf("  error: %s is too long!\n", name);
+        return 1;
+      }
+      strcpy(p->strValue, value);
+    }
+    return 0;
+  }
+
+  printf("  error: unknown option %s!\n", name);
+  return 1;
+}
+
+
+
+// reads lines of "name = value" or "name value"; # starts a comment
+static int paramsReadFile(struct collatzParam* params, const char* filename) {
+
+  FILE* fp = fopen(filename, "r");
+  if (!fp) {
+    printf("  error: cannot open %s!\n", filename);
+    return 1;
+  }
+
+  char line[512];
+  while (fgets(line, sizeof(line), fp)) {
+    char* hash = strchr(line, '#');
+    if (hash) *hash = '\0';
+    for (char* c = line; *c; c++) if (*c == '=') *c = ' ';
+
+    char name[256], value[256];
+    int got = sscanf(line, "%255s %255s", name, value);
+    if (got <= 0) continue;     // blank line
+    if (got == 1 || paramsSet(params, name, value)) {
+      if (got == 1) printf("  error: %s needs a value!\n", name);
+      fclose(fp);
+      return 1;
+    }
+  }
+
+  fclose(fp);
+  return 0;
+}
+
+
+
+/*
+  Reads --name value, --name=value, and --config file from the arguments
+  The other arguments are moved to the front of argv
+  Returns the new argc, or -1 if there was an error
+*/
+static int paramsParse(struct collatzParam* params, int argc, char* argv[]) {
+
+  int newArgc = 1;
+
+  for (int i = 1; i < argc; i++) {
+
+    if ( strncmp(argv[i], "--", 2) ) {
+      argv[newArgc++] = argv[i];
+      continue;
+    }
+
+    char name[256];
+    const char* value;
+    const char* equals = strchr(argv[i], '=');
+    if (equals) {
+      size_t len = equals - argv[i] - 2;
+      if (len >= sizeof(name)) len = sizeof(name) - 1;
+      memcpy(name, argv[i] + 2, len);
+      name[len] = '\0';
+      value = equals + 1;
+    } else {
+      if (i + 1 >= argc) {
+        printf("  error: %s needs a value!\n", argv[i]);
+        return -1;
+      }
+      strncpy(name, argv[i] + 2, sizeof(name) - 1);
+      name[sizeof(name) - 1] = '\0';
+      value = argv[++i];
+    }
+
+    if ( !strcmp(name, "config") ) {
+      if ( paramsReadFile(params, value) ) return -1;
+    } else {
+      if ( paramsSet(params, name, value) ) return -1;
+    }
+  }
+
+  return newArgc;
+}
+
+
+
+#ifndef PARAMS_NO_CHECK
+
+/*
+  Checks the rules for k, k1, k2, TASK_SIZE, and TASK_SIZE0
+  Use -1 for k1 or k2 if the host doesn't have it
+  Returns 0 if everything is fine
+*/
+static int paramsCheck(int k, int k1, int k2, int TASK_SIZE, int TASK_SIZE0) {
+
+  if ( k > 80 ) {
+    printf("Aborting. k < 81 must be true\n");
+    return 1;
+  }
+  if ( TASK_SIZE < 8 || TASK_SIZE > k ) {
+    printf("Aborting. 8 <= TASK_SIZE <= k must be true\n");
+    return 1;
+  }
+  if ( k - TASK_SIZE >= 64 ) {
+    printf("Aborting. k - TASK_SIZE < 64 must be true\n");
+    return 1;
+  }
+  if ( TASK_SIZE0 < k || TASK_SIZE0 - k > 124 ) {
+    printf("Aborting. k <= TASK_SIZE0 <= k + 124 must be true\n");
+    return 1;
+  }
+  if ( k1 >= 0 && (k1 < TASK_SIZE || k1 > k) ) {
+    printf("Aborting. TASK_SIZE <= k1 <= k must be true\n");
+    return 1;
+  }
+  if ( k2 >= 0 && (k2 < 4 || k2 > 36 || k2 > k) ) {
+    printf("Aborting. 3 < k2 < 37 and k2 <= k must be true\n");
+    return 1;
+  }
+
+  return 0;
+}
+
+#endif
+
+#endif
@@ -24,6 +24,8 @@ If that didn't make sense yet, don't worry about it. I just put it here to be wi
 I also use the "long long" function strtoull when reading in the arguments.
 
 Currently loads in a sieve file, which must must match the k1 value set in this code.
+The sieve file is memory mapped by sieveFile.h, which must be in the same folder.
+The first k steps of each b use a lookup table from collatzKsteps.h (also in the same folder).
 
 
 
@@ -60,7 +62,7 @@ This works if we test *all* not-excluded numbers n>1.
 
 This code tests all n = A*2^k + B where...
  - B is not excluded by a 2^k sieve
- - n is not excluded by a 3^2 sieve
+ - n is not excluded by a 3^2 sieve (or a 3^m sieve, see collatzMod3.h)
  - aStart <= A < aEnd
 You are free to set k yourself!
 
@@ -81,6 +83,8 @@ A better sieve is to also exclude n%9==4 numbers. This is a 3^2 sieve.
 There are tons of these rules, but almost all exclusions occur with the above rules.
   For example, all mod 3^9 rules will block only a few percent more n than a 3^2 sieve,
   but you won't gain because checking against these rules takes time.
+  Instead of checking each a, the next a that isn't excluded is found by a lookup table
+  (see collatzMod3.h), so compile with -DMOD3_POWER=m to try a 3^m sieve.
 
 
 
@@ -110,6 +114,16 @@ This is a minor improvement worth doing!
 
 If overflow is reached, you may have found a number that
   could disprove the conjecture! Overflow must be carefully checked.
+Numbers that overflow are run again using 256-bit integers (see collatzOverflow256.h),
+  and only numbers that overflow even that print "Overflow! nStart = ".
+Compile with -DCHECKSUM to also print a checksum and the max n (see collatzChecksum.h).
+Run with --json file to also append the results to file as a JSON line (see collatzJson.h).
+Run with --checkpoint name to save checkpoints, so that a stopped task
+  picks up where it left off when run again (see collatzCheckpoint.h).
+Run with --task_id0Count count to also run task_id0 + 1 ... task_id0 + count - 1
+  using the same part of the sieve file, so the sieve is read only once for all of them.
+  The a of these task_id0 are tested for each b before moving to the next b,
+  and the results of each task_id0 are printed (and written to --json) separately.
 If the code gets stuck on a certain number,
   you may also have disproved the conjecture!
 
@@ -135,6 +149,8 @@ Here is a neat way to run this code...
 To pick up where you left off, change the start (and stop) value of seq.
 k, TASK_SIZE, and TASK_SIZE0 should not change between runs.
 Change the -P argument of parallel to run more CPU threads at a time!
+Instead, collatzCoordinator.py (in the main folder) runs the task_id for you,
+  keeping a ledger of which are done, so nothing is skipped even after a crash.
 
 For each task_id0, 9 * 2 ^ TASK_SIZE0 numbers will be tested,
   but only after each task_id is run from 0 to ( 2^(k - TASK_SIZE) - 1 )
@@ -142,8 +158,7 @@ Why the 9? I thought it might help my GPU code, but it only does EXTREMELY SLIGH
 Feel free to get rid of the 9 when aStart and aSteps are defined in the code.
 You'll also want to get rid of the division by 9 when this host program
   checks if task_id0 will cause overflow.
-If task_id0 > 0, you'll also want to fix the line...
-  aMod = 0
+The 3^2 sieve works for any aStart (see collatzMod3.h).
 
 
 
@@ -171,6 +186,11 @@ Then set the following as your task_id...
 #include <sys/time.h>
 struct timeval tv1, tv2;
 
+#include "sieveFile.h"
+#include "collatzParams.h"
+#include "collatzKsteps.h"
+#include "collatzMod3.h"
+
 
 
 /*
@@ -180,10 +200,12 @@ struct timeval tv1, tv2;
      (minimum TASK_SIZE is 8)
   Due to the limits of strtoull(), k - TASK_SIZE < 64
   9 * 2^(TASK_SIZE0 + TASK_SIZE - k) numbers will be run by each process
+  These and the other values below are defaults that can be changed
+    at run time, such as by --TASK_SIZE 20 (see collatzParams.h)
 */
-const int k = 51;
-const int TASK_SIZE0 = 67;       // 9 * 2^TASK_SIZE0 numbers will be run total
-const int TASK_SIZE = 18;        // TASK_SIZE <= k
+int k = 51;
+int TASK_SIZE0 = 67;       // 9 * 2^TASK_SIZE0 numbers will be run total
+int TASK_SIZE = 18;        // TASK_SIZE <= k
 
 
 
@@ -197,25 +219,26 @@ const int TASK_SIZE = 18;        // TASK_SIZE <= k
 //   but, once you have the sieve file, use it!
 // Especially good values are 32, 35, 37, 40, ...
 
-const int k1 = 37;
+int k1 = 37;
 
-const char file[10] = "sieve37";
+char file[256] = "sieve37";
 
 
 
+char jsonFile[256] = "";  // set by --json to append results as a JSON line
 
+char checkpointFile[256] = "";   // set by --checkpoint to save checkpoints
+int checkpointSeconds = 60;
+
+int task_id0Count = 1;      // set by --task_id0Count to run task_id0 <= id0 < task_id0 + task_id0Count
 
 
-// 2^8 sieve
-const uint8_t sieveSmall[16] = {27, 31, 47, 71, 91, 103, 111, 127, 155, 159, 167, 191, 231, 239, 251, 255};
 
 
 
 
-// Code will test aStart <= a < aStart + aSteps
-// Set this to 2^0 = 1 to have get an idea of how long processing the sieve takes.
-// Ideally, I like to set this to at least 2^10.
-const __uint128_t aSteps = (__uint128_t)9 << (TASK_SIZE0 - k);
+// 2^8 sieve
+const uint8_t sieveSmall[16] = {27, 31, 47, 71, 91, 103, 111, 127, 155, 159, 167, 191, 231, 239, 251, 255};
 
 
 
@@ -233,8 +256,38 @@ void print128(__uint128_t n) {
 
 
 
+// for finishing numbers that overflow 128 bits
+#include "collatzOverflow256.h"
+
+// for the checksum and max n if compiled with -DCHECKSUM
+#include "collatzChecksum.h"
+
+// for --json
+#include "collatzJson.h"
+
+// for --checkpoint
+#include "collatzCheckpoint.h"
+
+
+
 int main(int argc, char *argv[]) {
 
+  // read options such as --TASK_SIZE 20 (see collatzParams.h)
+  struct collatzParam params[] = {
+    {"k", &k, NULL, 0},
+    {"TASK_SIZE0", &TASK_SIZE0, NULL, 0},
+    {"TASK_SIZE", &TASK_SIZE, NULL, 0},
+    {"k1", &k1, NULL, 0},
+    {"sieve", NULL, file, sizeof(file)},
+    {"json", NULL, jsonFile, sizeof(jsonFile)},
+    {"checkpoint", NULL, checkpointFile, sizeof(checkpointFile)},
+    {"checkpointSeconds", &checkpointSeconds, NULL, 0},
+    {"task_id0Count", &task_id0Count, NULL, 0},
+    {NULL, NULL, NULL, 0}
+  };
+  argc = paramsParse(params, argc, argv);
+  if ( argc < 0 || paramsCheck(k, k1, -1, TASK_SIZE, TASK_SIZE0) ) return 0;
+
   if( argc < 3 ) {
     printf("Too few arguments. Aborting.\n");
     return 0;
@@ -251,8 +304,17 @@ int main(int argc, char *argv[]) {
     return 0;
   }
 
+  if ( task_id0Count < 1 ) {
+    printf("Aborting. task_id0Count > 0 must be true\n");
+    return 0;
+  }
+
   printf("task_id0 = ");
   print128(task_id0);
+  if ( task_id0Count > 1 ) {
+    printf("task_id0Count = ");
+    print128(task_id0Count);
+  }
   printf("task_id = ");
   print128(task_id);
   printf("task_id must be less than ");
@@ -263,26 +325,31 @@ int main(int argc, char *argv[]) {
   print128(TASK_SIZE0);
   printf("k = %i\n", k);
   printf("k1 = %i\n", k1);
+  printf("sieve file = %s\n", file);
   fflush(stdout);
 
 
 
 
-  const __uint128_t k2 = (__uint128_t)1 << k;       // 2^k
   const __uint128_t UINTmax = -1;                   // trick to get all bits to be 1
 
 
-  if ( task_id0 > ( (UINTmax / 9) >> (TASK_SIZE0 - k) ) - 1 ) {
+  if ( task_id0 + task_id0Count - 1 > ( (UINTmax / 9) >> (TASK_SIZE0 - k) ) - 1 ) {
     printf("Error: Overflow!\n");
     return 0;
   }
+
+  // Code will test aStart <= a < aStart + aSteps
+  // Set this to 2^0 = 1 to have get an idea of how long processing the sieve takes.
+  // Ideally, I like to set this to at least 2^10.
+  const __uint128_t aSteps = (__uint128_t)9 << (TASK_SIZE0 - k);
   const __uint128_t aStart = (__uint128_t)task_id0*9 << (TASK_SIZE0 - k);
   const __uint128_t aEnd = aStart + aSteps;
 
+  // task_id0 + t has aStart + t*aSteps <= a < aEnd + t*aSteps (see --task_id0Count)
+  const __uint128_t aEndAll = aStart + aSteps*task_id0Count;
 
 
-  // 3 or 9 (the actual code must be changed to match, so keep it at 9)
-  const int modNum = 9;
 
   // 3^c = 2^(log2(3)*c) = 2^(1.585*c),
   //    so c=80 is the max to fit in 128-bit numbers.
@@ -301,16 +368,12 @@ int main(int argc, char *argv[]) {
 
 
   __uint128_t n, nStart, a;
-  int alpha, aMod, nMod, bMod, j;
+  int alpha, nMod, j;
 
 
-  //const int k2Mod = k2 % modNum;
-  //const int k2Mod = (k & 1) ? 2 : 1 ;   // trick for modNum == 3
-  uint64_t r = 0;    // trick for modNum == 9
-  r += (uint64_t)(k2)        & 0xfffffffffffffff;
-  r += (uint64_t)(k2 >>  60) & 0xfffffffffffffff;
-  r += (uint64_t)(k2 >> 120);
-  const int k2Mod = r%9;
+  // lookup tables for the 3^m sieve (see collatzMod3.h)
+  struct mod3Sieve m3;
+  mod3Init(&m3, k);
 
 
 
@@ -330,7 +393,7 @@ int main(int argc, char *argv[]) {
   // Note that after k steps for B = 2^k - 1, B will become 3^k - 1
   //   and A*2^k will become A*3^k
   const __uint128_t maxA = (UINTmax - c3[k] + 1) / c3[k];     // max a
-  if (aEnd - 1 > maxA) {
+  if (aEndAll - 1 > maxA) {
     printf("Error: a*2^k + (2^k - 1) will overflow after k steps!\n");
     return 0;
   }
@@ -339,46 +402,83 @@ int main(int argc, char *argv[]) {
 
 
 
+  // lookup table for doing the first k steps (see collatzKsteps.h)
+  struct kstepsTable kt;
+  if ( kstepsInit(&kt, KSTEPS_BITS) ) {
+    printf("  error: cannot make the k-steps table!\n");
+    return 0;
+  }
+
+
+
+
+
   gettimeofday(&tv1, NULL);    // start timer
 
   __uint128_t bStart = ( (__uint128_t)1 << TASK_SIZE )*task_id;
 
   __uint128_t countB = 0;    // to count the numbers that need testing in segment of 2^k sieve
 
+  // for each task_id0 if compiled with -DCHECKSUM (see collatzChecksum.h)
+  struct collatzChecksum* cs = (struct collatzChecksum*)malloc(task_id0Count * sizeof(struct collatzChecksum));
+  for (int t = 0; t < task_id0Count; t++) checksumInit(&cs[t]);
 
+  /*
+    Pick up from a checkpoint (see collatzCheckpoint.h)
+    Saved are the next pattern, countB, and cs of each task_id0
+  */
+  uint64_t checkp = 0;
+  const int cpCount = 2 + 3*task_id0Count;
+  __uint128_t* cpValues = (__uint128_t*)malloc(cpCount * sizeof(__uint128_t));
+  char cpID[512];
+  snprintf(cpID, sizeof(cpID), "partiallySieveless_npp k=%d k1=%d TASK_SIZE=%d TASK_SIZE0=%d task_id0=%llu task_id0Count=%d task_id=%llu",
+      k, k1, TASK_SIZE, TASK_SIZE0, (unsigned long long)task_id0, task_id0Count, (unsigned long long)task_id);
+  struct checkpoint cp;
+  checkpointInit(&cp, checkpointFile, checkpointSeconds, cpID, task_id0, task_id);
+  if ( checkpointLoad(&cp, cpValues, cpCount) ) {
+    checkp = (uint64_t)cpValues[0];
+    countB = cpValues[1];
+    for (int t = 0; t < task_id0Count; t++) {
+      cs[t].checksum = (uint64_t)cpValues[2 + 3*t];
+      cs[t].maxN = cpValues[3 + 3*t];
+      cs[t].maxNstart = cpValues[4 + 3*t];
+    }
+  }
 
 
 
 
-  /* open the 2^k1 sieve file */
 
-  FILE* fp;
-  size_t file_size;
 
-  // I will load only a single chunk of 2^k1 sieve into RAM at a time
-  fp = fopen(file, "rb");
-  const uint64_t bufferBytes = (uint64_t)1 << 13;    // 2^13 bytes = 8 kiB
-  uint16_t* data = (uint16_t*)malloc(bufferBytes);
+  /* open the 2^k1 sieve file (see sieveFile.h) */
 
-  // Check file size
-  // Bytes in sieve file are 2^(k1 - 7)
-  fseek(fp, 0, SEEK_END);
-  file_size = ftell(fp);
-  if ( file_size != ((size_t)1 << (k1 - 7)) ) {
+  struct sieveFile sf;
+  int sieveErr = sieveOpen(&sf, file, k1);
+  if ( sieveErr == SIEVE_ERR_OPEN ) {
+    printf("  error: cannot open sieve file!\n");
+    return 0;
+  }
+  if ( sieveErr == SIEVE_ERR_RAM ) {
+    printf("  error: not enough RAM for sieve file!\n");
+    return 0;
+  }
+  if ( sieveErr ) {
     printf("  error: wrong sieve file!\n");
     return 0;
   }
 
   /*
-    Seek to necessary part of the file
+    Get the 2^(TASK_SIZE - 8) patterns needed from the file
     Note that ((((uint64_t)1 << k1) - 1) & bStart) equals bStart % ((uint64_t)1 << k1)
+    A checkpoint is taken care of by starting at pattern checkp,
+      so data[0] is pattern checkp
   */
-  //rewind(fp);
-  fseek(fp, ((((uint64_t)1 << k1) - 1) & bStart) >> 7, SEEK_SET);
-
-  // for handling the buffer...
-  uint64_t bufferStepMax = bufferBytes >> 1;   // since each pattern is 2 bytes
-  uint64_t bufferStep = bufferStepMax;
+  const uint64_t patternEnd = (uint64_t)1 << (TASK_SIZE - 8);
+  const uint16_t* data = sieveLoad(&sf, (((((uint64_t)1 << k1) - 1) & bStart) >> 8) + checkp, patternEnd - checkp);
+  if (!data) {
+    printf("  error: cannot read sieve file! Aborting.\n");
+    return 0;
+  }
   uint16_t bytes;    // the current 2 bytes
 
 
@@ -388,15 +488,21 @@ int main(int argc, char *argv[]) {
   //////// test integers that aren't excluded by certain rules
   ////////////////////////////////////////////////////////////////
 
-  for (uint64_t pattern = 0; pattern < ((uint64_t)1 << (TASK_SIZE - 8)); pattern++) {
+  for (uint64_t pattern = checkp; pattern < patternEnd; pattern++) {
 
-    // get bytes
-    if (bufferStep >= bufferStepMax) {    // do we need to refresh buffer?
-      fread(data, sizeof(uint16_t), bufferBytes / sizeof(uint16_t), fp);
-      bufferStep = 0;
+    // save a checkpoint every so often
+    if ( (pattern & 511) == 0 && pattern != checkp && checkpointDue(&cp) ) {
+      cpValues[0] = pattern;
+      cpValues[1] = countB;
+      for (int t = 0; t < task_id0Count; t++) {
+        cpValues[2 + 3*t] = cs[t].checksum;
+        cpValues[3 + 3*t] = cs[t].maxN;
+        cpValues[4 + 3*t] = cs[t].maxNstart;
+      }
+      checkpointSave(&cp, cpValues, cpCount);
     }
-    bytes = data[bufferStep];
-    bufferStep++;
+
+    bytes = data[pattern - checkp];    // get bytes
 
     for (int bit = 0; bit < 16; bit ++) {      // loop over 16 bits in pattern
 
@@ -408,24 +514,12 @@ int main(int argc, char *argv[]) {
 
       __uint128_t b = bStart + pattern * 256 + sieveSmall[bit];
 
-      int go = 1;          // acts as a boolean
-      __uint128_t bb = b;  // will become fk(b)
-      int c = 0;           // number of increases experienced when calculated fk(b)
+      __uint128_t bb;  // will become fk(b)
+      int c;           // number of increases experienced when calculated fk(b)
 
       // check to see if 2^k*a + b is reduced in no more than k steps
-      for (j=0; j<k; j++) {   // step
-        if (bb & 1) {         // bitwise test for odd
-          bb = 3*(bb/2) + 2;  // note that bb is odd
-          c++;
-        } else {
-          bb >>= 1;
-          if (bb < b) {      // if 2^k*N + b is reduced to a*N + bb
-            go = 0;
-            break;
-          }
-        }
-      }
-      if ( go == 0 ) continue;
+      //   (if 2^k*N + b is reduced to a*N + bb with bb < b)
+      if ( kstepsReduce(&kt, b, b, k, &bb, &c) ) continue;
 
 
 
@@ -434,18 +528,8 @@ int main(int argc, char *argv[]) {
       //   Starting at b-1, compare the final b and c after k steps
       // This will take more time, and will only rule out a few more b values
 
-      __uint128_t bm = b - 1;
-      int cm = 0;
-
-      // take k steps to get bm and cm
-      for(j=0; j<k; j++) {
-        if (bm & 1) {
-          bm = 3*(bm/2) + 2;
-          cm++;
-        } else {
-          bm >>= 1;
-        }
-      }
+      int cm;
+      __uint128_t bm = kstepsFull(&kt, b - 1, k, &cm);
 
       // check bm and cm against bb and c
       if ( bm == bb && cm == c ) {
@@ -460,38 +544,19 @@ int main(int argc, char *argv[]) {
 
       countB++;
 
-      aMod = 0;
-
-      // a trick for modNum == 9 to get b%9 faster
-      uint64_t r = 0;
-      r += (uint64_t)(b)        & 0xfffffffffffffff;
-      r += (uint64_t)(b >>  60) & 0xfffffffffffffff;
-      r += (uint64_t)(b >> 120);
-      bMod = r%9;
-
-      for (a=aStart; a<aEnd; a++) {    // loop over a before next b (interlacing for speed)
-
-
-
-          // do a 3^2 sieve
-
-          nMod = (aMod * k2Mod + bMod) % modNum;
-
-          // iterate before the following possible continue
-          aMod++;
-          if (aMod == modNum) aMod = 0;
-
-          //if (nMod == 2) continue;    // modNum = 3
-          if (nMod == 2 || nMod == 4 || nMod == 5 || nMod == 8) {   // modNum = 9
-            continue;
-          }
-
+      // each task_id0 (see --task_id0Count)
+      for (int t = 0; t < task_id0Count; t++) {
 
+      // do a 3^m sieve by only going to the a that aren't excluded
+      a = aStart + t*aSteps;
+      nMod = mod3First(&m3, &a, b);
 
+      for (; a<aEnd + t*aSteps; a += m3.skip[nMod], nMod = m3.next[nMod]) {    // loop over a before next b (interlacing for speed)
 
           nStart = (a<<k) + b;
 
           n = a*c3[c] + bb;
+          CHECKSUM_ADD(&cs[t], c);
 
 
 
@@ -505,12 +570,13 @@ int main(int argc, char *argv[]) {
             n >>= alpha;
             //if ( alpha >= lenC3 || n > maxNs[alpha] ) {
             if ( n > maxNs[alpha] ) {
-              printf("Overflow! nStart = ");
-              print128(nStart);
+              overflow256(nStart, kt.step, kt.s);
               break;
             }
             n *= c3[alpha];   // 3^c from lookup table
             n--;
+            CHECKSUM_ADD(&cs[t], alpha);
+            CHECKSUM_MAX(&cs[t], n, nStart);
 
 even:
             if ((uint64_t)n == 0) n >>= 64;
@@ -521,20 +587,56 @@ even:
 
       }
 
+      }
+
     }
   }
 
   printf("  Numbers in sieve segment that needed testing = ");
   print128(countB);
+  for (int t = 0; t < task_id0Count; t++) {
+    if ( task_id0Count > 1 ) {
+      printf("task_id0 = ");
+      print128(task_id0 + t);
+    }
+    checksumPrint(&cs[t]);
+  }
 
   gettimeofday(&tv2, NULL);
-  printf("  %e seconds\n\n",
-      (double)(tv2.tv_usec - tv1.tv_usec) / 1000000.0 + (double)(tv2.tv_sec - tv1.tv_sec)); 
+  double seconds = (double)(tv2.tv_usec - tv1.tv_usec) / 1000000.0 + (double)(tv2.tv_sec - tv1.tv_sec);
+  printf("  %e seconds\n\n", seconds);
+
+  // the same results as a JSON line for each task_id0 (see collatzJson.h)
+  // Each task_id0 gets an equal share of the seconds, so that seconds can be added up
+  for (int t = 0; jsonFile[0] && t < task_id0Count; t++) {
+    struct jsonRecord j;
+    jsonStart(&j);
+    jsonString(&j, "code", "partiallySieveless_npp");
+    jsonInt(&j, "k", k);
+    jsonInt(&j, "k1", k1);
+    jsonInt(&j, "k2", -1);
+    jsonInt(&j, "deltaN", -1);
+    jsonInt(&j, "MOD3_POWER", MOD3_POWER);
+    jsonString(&j, "sieve", file);
+    jsonInt(&j, "TASK_SIZE", TASK_SIZE);
+    jsonInt(&j, "TASK_SIZE0", TASK_SIZE0);
+    jsonU128(&j, "task_id0", task_id0 + t);
+    jsonU128(&j, "task_id", task_id);
+    jsonU128(&j, "countB", countB);
+    jsonChecksum(&j, &cs[t]);
+    jsonOverflows(&j, k, bStart, bStart + ((__uint128_t)1 << TASK_SIZE), aStart + t*aSteps, aEnd + t*aSteps);
+    jsonDouble(&j, "seconds", seconds / task_id0Count);
+    if ( jsonWrite(&j, jsonFile) ) break;
+  }
+
+  checkpointRemove(&cp);
 
   // free memory (cuz why not?)
   free(maxNs);
   free(c3);
-  free(data);
-  fclose(fp);
+  free(cs);
+  free(cpValues);
+  sieveClose(&sf);
+  kstepsFree(&kt);
   return 0;
 }
@@ -26,6 +26,7 @@ I also use the "long long" function strtoull when reading in the arguments.
 Currently requires my cuda_uint128.h
 
 Currently loads in a sieve file, which must must match the k1 value set in this code.
+The sieve file is memory mapped by sieveFile.h, which must be in the same folder.
 
 
 
@@ -177,6 +178,9 @@ Then set the following as your task_id...
 #include <sys/time.h>
 struct timeval tv1, tv2;
 
+#include "sieveFile.h"
+#include "collatzParams.h"
+
 #define min(a,b) (((a)<(b))?(a):(b))
 
 
@@ -189,10 +193,12 @@ struct timeval tv1, tv2;
      (minimum TASK_SIZE is 8)
   Due to the limits of strtoull(), k - TASK_SIZE < 64
   9 * 2^(TASK_SIZE0 + TASK_SIZE - k) numbers will be run by each process
+  These and the other values below are defaults that can be changed
+    at run time, such as by --TASK_SIZE 20 (see collatzParams.h)
 */
-const int k = 51;
-const int TASK_SIZE0 = 67;       // 9 * 2^TASK_SIZE0 numbers will be run total
-const int TASK_SIZE = 18;        // TASK_SIZE <= k
+int k = 51;
+int TASK_SIZE0 = 67;       // 9 * 2^TASK_SIZE0 numbers will be run total
+int TASK_SIZE = 18;        // TASK_SIZE <= k
 
 
 
@@ -206,9 +212,9 @@ const int TASK_SIZE = 18;        // TASK_SIZE <= k
 //   but, once you have the sieve file, use it!
 // Especially good values are 32, 35, 37, 40, ...
 
-const int k1 = 37;
+int k1 = 37;
 
-const char file[10] = "sieve37";
+char file[256] = "sieve37";
 
 
 
@@ -220,14 +226,6 @@ const uint8_t sieveSmall[16] = {27, 31, 47, 71, 91, 103, 111, 127, 155, 159, 167
 
 
 
-
-// Code will test aStart <= a < aStart + aSteps
-// Set this to 2^0 = 1 to have get an idea of how long processing the sieve takes.
-// Ideally, I like to set this to at least 2^10.
-const __uint128_t aSteps = (__uint128_t)9 << (TASK_SIZE0 - k);
-
-
-
 // Prints __uint128_t numbers since printf("%llu\n", x) doesn't work
 //   since "long long" is only 64-bit in gcc.
 // This function works for any non-negative integer less than 128 bits.
@@ -244,6 +242,18 @@ void print128(__uint128_t n) {
 
 int main(int argc, char *argv[]) {
 
+  // read options such as --TASK_SIZE 20 (see collatzParams.h)
+  struct collatzParam params[] = {
+    {"k", &k, NULL, 0},
+    {"TASK_SIZE0", &TASK_SIZE0, NULL, 0},
+    {"TASK_SIZE", &TASK_SIZE, NULL, 0},
+    {"k1", &k1, NULL, 0},
+    {"sieve", NULL, file, sizeof(file)},
+    {NULL, NULL, NULL, 0}
+  };
+  argc = paramsParse(params, argc, argv);
+  if ( argc < 0 || paramsCheck(k, k1, -1, TASK_SIZE, TASK_SIZE0) ) return 0;
+
   if( argc < 3 ) {
     printf("Too few arguments. Aborting.\n");
     return 0;
@@ -272,6 +282,7 @@ int main(int argc, char *argv[]) {
   print128(TASK_SIZE0);
   printf("k = %i\n", k);
   printf("k1 = %i\n", k1);
+  printf("sieve file = %s\n", file);
   fflush(stdout);
 
 
@@ -285,6 +296,11 @@ int main(int argc, char *argv[]) {
     printf("Error: Overflow!\n");
     return 0;
   }
+
+  // Code will test aStart <= a < aStart + aSteps
+  // Set this to 2^0 = 1 to have get an idea of how long processing the sieve takes.
+  // Ideally, I like to set this to at least 2^10.
+  const __uint128_t aSteps = (__uint128_t)9 << (TASK_SIZE0 - k);
   const __uint128_t aStart = (__uint128_t)task_id0*9 << (TASK_SIZE0 - k);
   const __uint128_t aEnd = aStart + aSteps;
 
@@ -363,35 +379,32 @@ int main(int argc, char *argv[]) {
 
 
 
-  /* open the 2^k1 sieve file */
-
-  FILE* fp;
-  size_t file_size;
-
-  // I will load only a single chunk of 2^k1 sieve into RAM at a time
-  fp = fopen(file, "rb");
-  const uint64_t bufferBytes = (uint64_t)1 << 13;    // 2^13 bytes = 8 kiB
-  uint16_t* data = (uint16_t*)malloc(bufferBytes);
+  /* open the 2^k1 sieve file (see sieveFile.h) */
 
-  // Check file size
-  // Bytes in sieve file are 2^(k1 - 7)
-  fseek(fp, 0, SEEK_END);
-  file_size = ftell(fp);
-  if ( file_size != ((size_t)1 << (k1 - 7)) ) {
+  struct sieveFile sf;
+  int sieveErr = sieveOpen(&sf, file, k1);
+  if ( sieveErr == SIEVE_ERR_OPEN ) {
+    printf("  error: cannot open sieve file!\n");
+    return 0;
+  }
+  if ( sieveErr == SIEVE_ERR_RAM ) {
+    printf("  error: not enough RAM for sieve file!\n");
+    return 0;
+  }
+  if ( sieveErr ) {
     printf("  error: wrong sieve file!\n");
     return 0;
   }
 
   /*
-    Seek to necessary part of the file
+    Get the 2^(TASK_SIZE - 8) patterns needed from the file
     Note that ((((uint64_t)1 << k1) - 1) & bStart.lo) equals bStart % ((uint64_t)1 << k1)
   */
-  //rewind(fp);
-  fseek(fp, ((((uint64_t)1 << k1) - 1) & bStart.lo) >> 7, SEEK_SET);
-
-  // for handling the buffer...
-  uint64_t bufferStepMax = bufferBytes >> 1;   // since each pattern is 2 bytes
-  uint64_t bufferStep = bufferStepMax;
+  const uint16_t* data = sieveLoad(&sf, ((((uint64_t)1 << k1) - 1) & bStart.lo) >> 8, (uint64_t)1 << (TASK_SIZE - 8));
+  if (!data) {
+    printf("  error: cannot read sieve file! Aborting.\n");
+    return 0;
+  }
   uint16_t bytes;    // the current 2 bytes
 
 
@@ -413,13 +426,7 @@ int main(int argc, char *argv[]) {
 
   for (uint64_t pattern = 0; pattern < ((uint64_t)1 << (TASK_SIZE - 8)); pattern++) {
 
-    // get bytes
-    if (bufferStep >= bufferStepMax) {    // do we need to refresh buffer?
-      fread(data, sizeof(uint16_t), bufferBytes / sizeof(uint16_t), fp);
-      bufferStep = 0;
-    }
-    bytes = data[bufferStep];
-    bufferStep++;
+    bytes = data[pattern];    // get bytes
 
     for (int bit = 0; bit < 16; bit ++) {      // loop over 16 bits in pattern
 
@@ -560,7 +567,6 @@ int main(int argc, char *argv[]) {
   // free memory (cuz why not?)
   free(maxNs);
   free(c3);
-  free(data);
-  fclose(fp);
+  sieveClose(&sf);
   return 0;
 }
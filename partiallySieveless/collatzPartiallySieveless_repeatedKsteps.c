@@ -13,11 +13,22 @@ You'll need a 64-bit computer with a not-ancient version of gcc
   in order for __uint128_t to work. This gives a 128-bit integer!
 Compile using something like...
   gcc -O3 collatzPartiallySieveless_repeatedKsteps.c
+To run many task_id in one process using all CPU threads, compile using...
+  gcc -O3 -fopenmp collatzPartiallySieveless_repeatedKsteps.c
+Without -fopenmp, the #pragma lines are ignored and a single thread is used.
+On a CPU with AVX-512, many numbers are tested at once if also using -march=native
+  (see repeatedKstepsLanes.h, which must be in the same folder).
+For large k2, several numbers are stepped in turn so that the lookups of the
+  2^k2 table don't wait on RAM one at a time (see repeatedKstepsInterleave.h).
 
 I use __builtin_ctzll(), which should be at least for 64-bit integers.
 Note that I use the "long long" function strtoull() when reading in the arguments.
 
 Currently loads in a sieve file, which must must match the k1 value set in this code.
+The sieve file is memory mapped by sieveFile.h, which must be in the same folder.
+The first k steps of each b use a lookup table from collatzKsteps.h (also in the same folder).
+With --tables folder, the 2^k2 table is saved to folder (which must exist) the first time,
+  then memory mapped by every run after that (see tableFile.h, also in the same folder).
 
 Sieves of size 2^k are used, where k can be very large!
 Minimal RAM used to store the 2^k2 sieve.
@@ -63,7 +74,7 @@ This works if we test *all* not-excluded numbers n>1.
 
 This code tests all n = A*2^k + B where...
  - B is not excluded by a 2^k sieve
- - n is not excluded by a 3^2 sieve
+ - n is not excluded by a 3^2 sieve (or a 3^m sieve, see collatzMod3.h)
  - aStart <= A < aEnd
 You are free to set k yourself!
 
@@ -79,6 +90,8 @@ A better sieve is to also exclude n%9==4 numbers. This is a 3^2 sieve.
 There are tons of these rules, but almost all exclusions occur with the above rules.
   For example, all mod 3^9 rules will block only a few percent more n than a 3^2 sieve,
   but you won't gain because checking against these rules takes time.
+  Instead of checking each a, the next a that isn't excluded is found by a lookup table
+  (see collatzMod3.h), so compile with -DMOD3_POWER=m to try a 3^m sieve.
 
 
 
@@ -108,6 +121,17 @@ This is a minor improvement worth doing!
 
 If overflow is reached, you may have found a number that
   could disprove the conjecture! Overflow must be carefully checked.
+Numbers that overflow are run again using 256-bit integers (see collatzOverflow256.h),
+  and only numbers that overflow even that print "Overflow! nStart = ".
+Compile with -DCHECKSUM to also print a checksum and the max n (see collatzChecksum.h).
+Run with --json file to also append the results to file as JSON lines,
+  one for each task_id (see collatzJson.h).
+Run with --checkpoint name to save checkpoints, so that a stopped run
+  picks up where it left off when run again (see collatzCheckpoint.h).
+Run with --task_id0Count count to also run task_id0 + 1 ... task_id0 + count - 1
+  using the same part of the sieve file, so each b is found only once for all of them.
+  The a of these task_id0 are tested for each b before moving to the next b,
+  and the results of each task_id0 are printed (and written to --json) separately.
 If the code gets stuck on a certain number,
   you may also have disproved the conjecture!
 
@@ -128,6 +152,30 @@ Here is a neat way to run this code...
 To pick up where you left off, change the start (and stop) value of seq.
 k, TASK_SIZE, and TASK_SIZE0 should not change between runs.
 Change the -P argument of parallel to run more CPU threads at a time!
+Instead, collatzCoordinator.py (in the main folder) runs the task_id for you,
+  keeping a ledger of which are done, so nothing is skipped even after a crash.
+
+Instead of parallel, a single process can run a range of task_id...
+  ./a.out  task_id0  task_id  task_idEnd
+which runs task_id <= id < task_idEnd using OpenMP (compile with -fopenmp).
+All threads share the same arrayk2[], c3[], maxNs[], and sieve file,
+  so RAM and storage reads do not grow with the number of threads.
+Each 2-byte pattern of the 2^k1 sieve is its own piece of work,
+  and idle threads grab the next unclaimed pattern of any task_id,
+  so a task_id with a dense part of the sieve doesn't leave threads idle.
+Set the number of threads via the OMP_NUM_THREADS environment variable...
+  OMP_NUM_THREADS=64 ./a.out 0 0 1024 |tee -a log.txt &
+
+For small TASK_SIZE, making the tables and opening the sieve file can take
+  longer than the task itself, so the code can instead stay running...
+  ./a.out --worker
+which reads lines of "task_id0 task_id" or "task_id0 task_id task_idEnd" from stdin,
+  runs each using the same tables and sieve file, then prints "worker: done" and the line.
+For example...
+  seq -f "0 %1.0f" 0 1048575 | ./a.out --worker --json results.jsonl |tee -a log.txt &
+Use the --worker option of collatzCoordinator.py to run one worker per core.
+For a local socket instead of stdin, use something like...
+  socat UNIX-LISTEN:worker.sock,fork EXEC:"./a.out --worker"
 
 For each task_id0, 9 * 2 ^ TASK_SIZE0 numbers will be tested,
   but only after each task_id is run from 0 to ( 2^(k - TASK_SIZE) - 1 )
@@ -135,8 +183,7 @@ Why the 9? I thought it might help my GPU code, but it only does EXTREMELY SLIGH
 Feel free to get rid of the 9 when aStart and aSteps are defined in the code.
 You'll also want to get rid of the division by 9 when this host program
   checks if task_id0 will cause overflow.
-If task_id0 > 0, you'll also want to fix the line...
-  aMod = 0
+The 3^2 sieve works for any aStart (see collatzMod3.h).
 
 
 
@@ -161,10 +208,21 @@ Then set the following as your TASK_ID...
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include <sys/time.h>
 struct timeval tv1, tv2;
 
+#include "sieveFile.h"
+#include "tableFile.h"
+#include "collatzParams.h"
+#include "collatzKsteps.h"
+#include "collatzMod3.h"
+
 
 
 /*
@@ -174,10 +232,12 @@ struct timeval tv1, tv2;
      (minimum TASK_SIZE is 8)
   Due to the limits of strtoull(), k - TASK_SIZE < 64
   9 * 2^(TASK_SIZE0 + TASK_SIZE - k) numbers will be run by each process
+  These and the other values below are defaults that can be changed
+    at run time, such as by --k2 13 (see collatzParams.h)
 */
-const int k = 51;
-const int TASK_SIZE0 = 67;       // 9 * 2^TASK_SIZE0 numbers will be run total
-const int TASK_SIZE = 20;        // TASK_SIZE <= k
+int k = 51;
+int TASK_SIZE0 = 67;       // 9 * 2^TASK_SIZE0 numbers will be run total
+int TASK_SIZE = 20;        // TASK_SIZE <= k
 
 
 
@@ -186,8 +246,12 @@ const int TASK_SIZE = 20;        // TASK_SIZE <= k
   3 < k2 < 37
   Will use more than 2^(k2 + 3) bytes of RAM
   For my CPU, 11 is the best because it fits in cache
+  To find the best k2 for your CPU (use the same k, k1, sieve file, and threads)...
+    ./a.out --tune myProfile
+  which saves the fastest k2 to myProfile for use by...
+    ./a.out --config myProfile  task_id0  task_id
 */
-const int k2 = 11;
+int k2 = 11;
 
 
 
@@ -199,26 +263,28 @@ const int k2 = 11;
 //   but, once you have the sieve file, use it!
 // Especially good values are 32, 35, 37, 40, ...
 
-const int k1 = 37;
+int k1 = 37;
 
-const char file[10] = "sieve37";
+char file[256] = "sieve37";
 
 
 
+char jsonFile[256] = "";  // set by --json to append results as JSON lines
 
+char tables[256] = "";    // set by --tables to keep arrayk2[] in this folder (see tableFile.h)
 
+char checkpointFile[256] = "";   // set by --checkpoint to save checkpoints
+int checkpointSeconds = 60;
 
-// 2^8 sieve
-const uint8_t sieveSmall[16] = {27, 31, 47, 71, 91, 103, 111, 127, 155, 159, 167, 191, 231, 239, 251, 255};
+int task_id0Count = 1;      // set by --task_id0Count to run task_id0 <= id0 < task_id0 + task_id0Count
 
 
 
 
 
-// Code will test aStart <= a < aStart + aSteps
-// Set this to 2^0 = 1 to have get an idea of how long processing the sieve takes.
-// Ideally, I like to set this to at least 2^10.
-const __uint128_t aSteps = (__uint128_t)9 << (TASK_SIZE0 - k);
+
+// 2^8 sieve
+const uint8_t sieveSmall[16] = {27, 31, 47, 71, 91, 103, 111, 127, 155, 159, 167, 191, 231, 239, 251, 255};
 
 
 
@@ -236,158 +302,231 @@ void print128(__uint128_t n) {
 
 
 
-int main(int argc, char *argv[]) {
+// for finishing numbers that overflow 128 bits
+#include "collatzOverflow256.h"
 
-  if( argc < 3 ) {
-    printf("Too few arguments. Aborting.\n");
-    return 0;
-  }
+// for the checksum and max n if compiled with -DCHECKSUM
+#include "collatzChecksum.h"
 
-  uint64_t task_id0 = (uint64_t)strtoull(argv[1], NULL, 10);
+// for --json
+#include "collatzJson.h"
 
-  uint64_t task_id  = (uint64_t)strtoull(argv[2], NULL, 10);
+// for --checkpoint
+#include "collatzCheckpoint.h"
 
-  uint64_t maxTaskID = ((uint64_t)1 << (k - TASK_SIZE));
-  if ( task_id >= maxTaskID ) {
-    printf("Aborting. task_id must be less than ");
-    print128( maxTaskID );
-    return 0;
-  }
+// if compiled for AVX-512, defines LANES and testLanes()
+#include "repeatedKstepsLanes.h"
 
-  printf("task_id0 = ");
-  print128(task_id0);
-  printf("task_id = ");
-  print128(task_id);
-  printf("task_id must be less than ");
-  print128(maxTaskID);
-  printf("TASK_SIZE = ");
-  print128(TASK_SIZE);
-  printf("TASK_SIZE0 = ");
-  print128(TASK_SIZE0);
-  printf("  k = %i\n", k);
-  printf("  k1 = %i\n", k1);
-  printf("  k2 = %i\n", k2);
-  fflush(stdout);
+// for large k2, defines INTERLEAVE and testInterleaved()
+#include "repeatedKstepsInterleave.h"
 
 
 
+/*
+  Tests n = a*2^k + b for aStart <= a < aEnd that aren't excluded by the 3^m sieve (see collatzMod3.h)
+  bb = fk(b), c = number of increases in first k steps
+  k2 is an argument so that testAllA() can make the compiler use a constant k2
+  packed is too, and, if 1, arrayk2packed[] is used instead of arrayk2[] (see makeArrayk2packed())
+  Returns how many times k2 steps were done, and adds to overflows and cs (see collatzChecksum.h)
+*/
+static inline __attribute__((always_inline)) uint64_t testA(const int k2, const int packed,
+    const uint64_t* arrayk2, const uint32_t* arrayk2packed, const __uint128_t* c3, const __uint128_t* maxNs,
+    const __uint128_t aStart, const __uint128_t aEnd,
+    const __uint128_t b, const __uint128_t bb, const int c,
+    const struct mod3Sieve* m3, uint64_t* overflows, struct collatzChecksum* cs) {
 
-  const __uint128_t kk = (__uint128_t)1 << k;       // 2^k
   const __uint128_t UINTmax = -1;                   // trick to get all bits to be 1
 
+  __uint128_t n, nStart;
+  __uint128_t a = aStart;
+  uint64_t steps = 0;
 
-  if ( task_id0 > ( (UINTmax / 9) >> (TASK_SIZE0 - k) ) - 1 ) {
-    printf("Error: Overflow!\n");
-    return 0;
-  }
-  const __uint128_t aStart = (__uint128_t)task_id0*9 << (TASK_SIZE0 - k);
-  const __uint128_t aEnd = aStart + aSteps;
-
-
-
-  // 3 or 9 (the actual code must be changed to match, so keep it at 9)
-  const int modNum = 9;
-
-  // 3^c = 2^(log2(3)*c) = 2^(1.585*c),
-  //    so c=80 is the max to fit in 128-bit numbers.
-  // Note that c3[0] = 3^0
-  //const int lenC3 = 81;  // for 128-bit numbers
-  const int lenC3 = k+1;
-
+  // do a 3^m sieve by only going to the a that aren't excluded
+  int nMod = mod3First(m3, &a, b);
 
+  for (; a<aEnd; a += m3->skip[nMod], nMod = m3->next[nMod]) {    // loop over a before next b (interlacing for speed)
 
+      nStart = (a<<k) + b;
 
-  __uint128_t n, nStart, a;
-  int alpha, aMod, nMod, bMod, j;
+      n = a*c3[c] + bb;
+      CHECKSUM_ADD(cs, c);
 
 
-  //const int kkMod = kk % modNum;
-  //const int kkMod = (k & 1) ? 2 : 1 ;   // trick for modNum == 3
-  uint64_t r = 0;    // trick for modNum == 9
-  r += (uint64_t)(kk)        & 0xfffffffffffffff;
-  r += (uint64_t)(kk >>  60) & 0xfffffffffffffff;
-  r += (uint64_t)(kk >> 120);
-  const int kkMod = r%9;
+      /* do k2 steps at a time */
+      do {
+          steps++;
+          size_t index = n & ( ((uint64_t)1<<k2) - 1 );  // get lowest k2 bits of n
+          uint64_t newB;
+          size_t newC;
+          if (packed) {
+            newB = arrayk2packed[index];
+            newC = newB >> 27;         // just 5 bits gives c
+            newB &= 0x7ffffff;         // rest of bits gives b
+          } else {
+            newB = arrayk2[index];
+            newC = newB >> 58;    // just 6 bits gives c
+            newB &= 0x3ffffffffffffff;   // rest of bits gives b
+          }
 
+          /* find the new n */
+          //n = (n >> k2)*c3[newC] + newB;
+          n >>= k2;
+          if (n > maxNs[newC]) {
+#ifdef _OPENMP
+              #pragma omp critical
+#endif
+              {
+              overflow256(nStart, arrayk2, k2);
+              }
+              (*overflows)++;
+              break;
+          }
+          n *= c3[newC];
+          if (n > UINTmax - newB) {
+#ifdef _OPENMP
+              #pragma omp critical
+#endif
+              {
+              overflow256(nStart, arrayk2, k2);
+              }
+              (*overflows)++;
+              break;
+          }
+          n += newB;
+          CHECKSUM_ADD(cs, k2);
+          CHECKSUM_MAX(cs, n, nStart);
 
+          if (n < nStart) break;
+      } while (1);
 
-  // calculate lookup table for c3, which is 3^c
-  __uint128_t* c3 = (__uint128_t*)malloc(lenC3*sizeof(__uint128_t));
-  c3[0] = 1;
-  for (j=1; j<lenC3; j++) { c3[j] = c3[j-1]*3; }
+  }
 
+  return steps;
+}
 
-  // defining max values is very important to detect overflow
-  // calculate lookup table for maxNs
-  __uint128_t* maxNs = (__uint128_t*)malloc(lenC3*sizeof(__uint128_t));
-  for (j=0; j<lenC3; j++) { maxNs[j] = UINTmax / c3[j]; }
 
 
-  // Test a for overflow
-  // Note that after k steps for B = 2^k - 1, B will become 3^k - 1
-  //   and A*2^k will become A*3^k
-  const __uint128_t maxA = (UINTmax - c3[k] + 1) / c3[k];     // max a
-  if (aEnd - 1 > maxA) {
-    printf("Error: a*2^k + (2^k - 1) will overflow after k steps!\n");
-    return 0;
+/*
+  Since k2 is set at run time, the common values of k2 each get their own copy
+    of testA() with k2 known at compile time, so the inner loop stays fast.
+  Other k2 use the slightly slower testA() with k2 not known.
+  Each also gets a copy for arrayk2packed[], which is used if it isn't NULL.
+*/
+static uint64_t testAllA(const int k2,
+    const uint64_t* arrayk2, const uint32_t* arrayk2packed, const __uint128_t* c3, const __uint128_t* maxNs,
+    const __uint128_t aStart, const __uint128_t aEnd,
+    const __uint128_t b, const __uint128_t bb, const int c,
+    const struct mod3Sieve* m3, uint64_t* overflows, struct collatzChecksum* cs) {
+
+#define TEST_A(K2) ( arrayk2packed ? \
+    testA(K2, 1, arrayk2, arrayk2packed, c3, maxNs, aStart, aEnd, b, bb, c, m3, overflows, cs) : \
+    testA(K2, 0, arrayk2, arrayk2packed, c3, maxNs, aStart, aEnd, b, bb, c, m3, overflows, cs) )
+  switch (k2) {
+    case 10: return TEST_A(10);
+    case 11: return TEST_A(11);
+    case 12: return TEST_A(12);
+    case 13: return TEST_A(13);
+    case 14: return TEST_A(14);
+    case 15: return TEST_A(15);
+    case 16: return TEST_A(16);
+    case 17: return TEST_A(17);
+    case 18: return TEST_A(18);
+    default: return TEST_A(k2);
   }
+#undef TEST_A
+}
 
 
 
+// lookup table for doing the first k steps (see collatzKsteps.h)
+struct kstepsTable kt;
 
+// lookup tables for the 3^m sieve (see collatzMod3.h)
+struct mod3Sieve m3;
 
-  gettimeofday(&tv1, NULL);    // start timer
 
-  __uint128_t bStart = ( (__uint128_t)1 << TASK_SIZE )*task_id;
 
-  __uint128_t countB = 0;    // to count the numbers that need testing in segment of 2^k sieve
+/*
+  Takes k steps for b to get fk(b) and c
+  Returns 0 if b doesn't need testing
+*/
+static int stepB(const __uint128_t b, __uint128_t* bbOut, int* cOut) {
 
+  __uint128_t bb;  // will become fk(b)
+  int c;           // number of increases experienced when calculated fk(b)
 
+  // check to see if 2^k*N + b is reduced in no more than k steps
+  //   (if 2^k*N + b is reduced to a*N + bb with bb < b)
+  if ( kstepsReduce(&kt, b, b, k, &bb, &c) ) return 0;
 
 
 
-  /* open the 2^k1 sieve file */
 
-  FILE* fp;
-  size_t file_size;
+  // Try another method to rule out the b...
+  //   Starting at b-1, compare the final b and c after k steps
+  // This will take more time, and will only rule out a few more b values
 
-  // I will load only a single chunk of 2^k1 sieve into RAM at a time
-  fp = fopen(file, "rb");
-  const uint64_t bufferBytes = (uint64_t)1 << 13;    // 2^13 bytes = 8 kiB
-  uint16_t* data = (uint16_t*)malloc(bufferBytes);
+  int cm;
+  __uint128_t bm = kstepsFull(&kt, b - 1, k, &cm);
 
-  // Check file size
-  // Bytes in sieve file are 2^(k1 - 7)
-  fseek(fp, 0, SEEK_END);
-  file_size = ftell(fp);
-  if ( file_size != ((size_t)1 << (k1 - 7)) ) {
-    printf("  error: wrong sieve file!\n");
+  // check bm and cm against bb and c
+  if ( bm == bb && cm == c ) {
     return 0;
+    //print128(b);
   }
 
-  /*
-    Seek to necessary part of the file
-    Note that ((((uint64_t)1 << k1) - 1) & bStart) equals bStart % ((uint64_t)1 << k1)
-  */
-  //rewind(fp);
-  fseek(fp, ((((uint64_t)1 << k1) - 1) & bStart) >> 7, SEEK_SET);
+  *bbOut = bb;
+  *cOut = c;
+  return 1;
+}
 
-  // for handling the buffer...
-  uint64_t bufferStepMax = bufferBytes >> 1;   // since each pattern is 2 bytes
-  uint64_t bufferStep = bufferStepMax;
-  uint16_t bytes;    // the current 2 bytes
 
 
+// tests all aStart <= a < aEnd for a b that needs testing, adding to overflows and cs (see collatzChecksum.h)
+static void testB(const int k2,
+    const uint64_t* arrayk2, const uint32_t* arrayk2packed, const __uint128_t* c3, const uint64_t* c3small, const __uint128_t* maxNs,
+    const __uint128_t aStart, const __uint128_t aEnd,
+    const __uint128_t b, const __uint128_t bb, const int c,
+    uint64_t* overflows, struct collatzChecksum* cs) {
 
+#ifdef LANES
+  // step many a at once (see repeatedKstepsLanes.h)
+  if (k2 < 21) {
+    testLanes(arrayk2, k2, c3, c3small, k, aStart, aEnd, b, bb, c, &m3, overflows, cs);
+    return;
+  }
+#else
+  (void)c3small;    // only for the lanes
+#endif
+
+#ifdef INTERLEAVE
+  // step many a in turn so that the large table doesn't wait on RAM (see repeatedKstepsInterleave.h)
+  if (k2 >= INTERLEAVE_K2) {
+    testInterleaved(arrayk2, k2, c3, maxNs, k, aStart, aEnd, b, bb, c, &m3, overflows, cs);
+    return;
+  }
+#endif
+
+  testAllA(k2, arrayk2, arrayk2packed, c3, maxNs, aStart, aEnd, b, bb, c, &m3, overflows, cs);
+}
 
 
-  ////////////////////////////////////////////////////////////////
-  //////// create arrayk2[] for the 2^k2 sieve
-  ////////////////////////////////////////////////////////////////
 
 #define min(a,b) (((a)<(b))?(a):(b))
 
-  uint64_t *arrayk2 = malloc(sizeof(uint64_t) * ((size_t)1 << k2));
+/*
+  Creates arrayk2[] for the 2^k2 sieve
+  With --tables, it is instead read from the folder if it was made before (see tableFile.h)
+  Use tableFree(tf) when done
+*/
+static const uint64_t* makeArrayk2(struct tableFile* tf, const int k2, const __uint128_t* c3) {
+
+  char name[300] = "";
+  if ( tables[0] ) snprintf(name, sizeof(name), "%s/arrayk2_%d", tables, k2);
+  const uint64_t* table = (const uint64_t*)tableLoad(tf, name, TABLE_ARRAYK2, k2, sizeof(uint64_t));
+  if (table) return table;
+
+  uint64_t *arrayk2 = (uint64_t*)tableNew(tf, k2, sizeof(uint64_t));
 
   for (size_t index = 0; index < ((size_t)1 << k2); ++index) {
 
@@ -433,161 +572,716 @@ next:
 
   }
 
+  tableSave(tf, name, TABLE_ARRAYK2, k2, sizeof(uint64_t));
+  return arrayk2;
+}
 
 
 
+/*
+  For k2 <= ARRAYK2_PACKED_MAX, each entry of arrayk2[] fits in 32 bits
+    since b < 3^17 < 2^27 and c <= 17 < 2^5,
+    so this makes a copy of arrayk2[] with b + (c<<27) in each entry.
+  This table needs half as much cache, so more of it stays in L1 and L2 cache.
+  On my CPU (48 KiB L1 cache), --tune found k2 = 13 to 17 to be 3% to 5% faster,
+    but, for k2 = 11, the 64-bit table already fits in L1 cache, and it was 2% slower,
+    so it is only used for k2 >= ARRAYK2_PACKED_MIN.
+  The 64-bit arrayk2[] is still needed by overflow256() and by the SIMD lanes.
+  Returns NULL if not used, else free() it when done
+  To not use it, compile with -DNO_PACKED_ARRAYK2
+*/
+#define ARRAYK2_PACKED_MIN 13
+#define ARRAYK2_PACKED_MAX 17
+static uint32_t* makeArrayk2packed(const uint64_t* arrayk2, const int k2) {
+#if defined(NO_PACKED_ARRAYK2) || defined(LANES)
+  (void)arrayk2;
+  (void)k2;
+  return NULL;     // the lanes gather 64-bit entries
+#else
+  if (k2 < ARRAYK2_PACKED_MIN || k2 > ARRAYK2_PACKED_MAX) return NULL;
+  uint32_t* packed = (uint32_t*)malloc(sizeof(uint32_t) << k2);
+  if (!packed) return NULL;
+  for (size_t index = 0; index < ((size_t)1 << k2); index++) {
+    uint64_t newB = arrayk2[index];
+    packed[index] = (uint32_t)(newB & 0x3ffffffffffffff) | (uint32_t)((newB >> 58) << 27);
+  }
+  return packed;
+#endif
+}
 
-  ////////////////////////////////////////////////////////////////
-  //////// test integers that aren't excluded by certain rules
-  ////////////////////////////////////////////////////////////////
 
-  for (uint64_t pattern = 0; pattern < ((uint64_t)1 << (TASK_SIZE - 8)); pattern++) {
 
-    // get bytes
-    if (bufferStep >= bufferStepMax) {    // do we need to refresh buffer?
-      fread(data, sizeof(uint16_t), bufferBytes / sizeof(uint16_t), fp);
-      bufferStep = 0;
-    }
-    bytes = data[bufferStep];
-    bufferStep++;
+/*
+  For --tune profileFile
+  Tests the same sample of numbers for each k2, then saves the fastest k2
+    to profileFile, which can then be used via --config profileFile
+  The sample is the first tuneBs b that need testing starting at
+    pseudorandom patterns of the 2^k1 sieve, each with 2^tuneALog2 a values.
+  All CPU threads are used (if compiled with -fopenmp) because threads share cache.
+*/
+const int tuneBs = 256;
+const int tuneALog2 = 14;
+const int tuneK2min = 8;
+const int tuneK2max = 22;
 
-    for (int bit = 0; bit < 16; bit ++) {      // loop over 16 bits in pattern
+static int tuneK2(const char* profile) {
 
-      // allow the 2^k1 sieve to help!
+  int j;
+  const __uint128_t UINTmax = -1;
+
+  const int lenC3 = k+1;
+  __uint128_t* c3 = (__uint128_t*)malloc(lenC3*sizeof(__uint128_t));
+  c3[0] = 1;
+  for (j=1; j<lenC3; j++) { c3[j] = c3[j-1]*3; }
+  __uint128_t* maxNs = (__uint128_t*)malloc(lenC3*sizeof(__uint128_t));
+  for (j=0; j<lenC3; j++) { maxNs[j] = UINTmax / c3[j]; }
+  uint64_t c3small[21];
+  for (j=0; j<21; j++) { c3small[j] = (j<lenC3) ? (uint64_t)c3[j] : 0; }
+
+  // use the a of task_id0 = 1 unless they could overflow
+  const __uint128_t maxA = (UINTmax - c3[k] + 1) / c3[k];
+  const __uint128_t aSteps = (__uint128_t)1 << tuneALog2;
+  __uint128_t aStart = (__uint128_t)9 << (TASK_SIZE0 - k);
+  if ( TASK_SIZE0 - k > 120 || aStart + aSteps - 1 > maxA ) aStart = 0;
+  const __uint128_t aEnd = aStart + aSteps;
+
+
+
+  /* get the sample of b */
+
+  struct sieveFile sf;
+  if ( sieveOpen(&sf, file, k1) ) {
+    printf("  error: cannot open sieve file or wrong sieve file!\n");
+    return 0;
+  }
+
+  __uint128_t bList[tuneBs], bbList[tuneBs];
+  int cList[tuneBs];
+  int count = 0;
+  uint64_t x = 12345;     // for pseudorandom patterns
+  while (count < tuneBs) {
+    x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    uint64_t pattern = (x >> 16) % sf.patternCount;
+    const uint16_t* data = sieveLoad(&sf, pattern, 1);
+    if (!data) {
+      printf("  error: cannot read sieve file! Aborting.\n");
+      return 0;
+    }
+    uint16_t bytes = *data;
+    for (int bit = 0; bit < 16 && count < tuneBs; bit++) {
       if ( !( bytes & (1 << bit) ) ) continue;
-      //countB++;
+      __uint128_t b = (__uint128_t)pattern * 256 + sieveSmall[bit];
+      if ( !stepB(b, &bbList[count], &cList[count]) ) continue;
+      bList[count] = b;
+      count++;
+    }
+  }
+  sieveClose(&sf);
+
+  // count the numbers that pass the 3^m sieve
+  uint64_t numbers = 0;
+  for (int i = 0; i < tuneBs; i++) {
+    __uint128_t a = aStart;
+    int nMod = mod3First(&m3, &a, bList[i]);
+    for (; a < aEnd; a += m3.skip[nMod], nMod = m3.next[nMod]) numbers++;
+  }
 
+  printf("  tuning k2 using %i b and 2^%i a for each b\n", tuneBs, tuneALog2);
+  printf("  k2   numbers/second   (for %i <= k2 <= %i, also with the 64-bit entries of arrayk2[])\n",
+      ARRAYK2_PACKED_MIN, ARRAYK2_PACKED_MAX);
+  fflush(stdout);
 
 
-      __uint128_t b = bStart + pattern * 256 + sieveSmall[bit];
 
-      int go = 1;          // acts as a boolean
-      __uint128_t bb = b;  // will become fk(b)
-      int c = 0;           // number of increases experienced when calculated fk(b)
-
-      // check to see if 2^k*N + b is reduced in no more than k steps
-      for (j=0; j<k; j++) {   // step
-        if (bb & 1) {         // bitwise test for odd
-          bb = 3*(bb/2) + 2;  // note that bb is odd
-          c++;
-        } else {
-          bb >>= 1;
-          if (bb < b) {      // if 2^k*N + b is reduced to a*N + bb
-            go = 0;
-            break;
-          }
-        }
+  /* time each k2 */
+
+  int k2max = min(tuneK2max, k);
+  double speeds[64];
+  int best = tuneK2min;
+
+  for (int k2 = tuneK2min; k2 <= k2max; k2++) {
+
+    struct tableFile tf;
+    const uint64_t* arrayk2 = makeArrayk2(&tf, k2, c3);
+    uint32_t* arrayk2packed = makeArrayk2packed(arrayk2, k2);
+    const int passes = arrayk2packed ? 2 : 1;
+
+    // the best of 3 runs, then again without arrayk2packed[] to see how much it helps
+    double bestSeconds[2] = {1e30, 1e30};
+    for (int pass = 0; pass < passes; pass++)
+    for (int run = 0; run < 3; run++) {
+      const uint32_t* table32 = pass ? NULL : arrayk2packed;
+      struct timeval t1, t2;
+      gettimeofday(&t1, NULL);
+
+#ifdef _OPENMP
+      #pragma omp parallel for schedule(dynamic, 1)
+#endif
+      for (int i = 0; i < tuneBs; i++) {
+        uint64_t overflows = 0;      // not used here
+        struct collatzChecksum cs;   // not used here
+        checksumInit(&cs);
+        testB(k2, arrayk2, table32, c3, c3small, maxNs, aStart, aEnd, bList[i], bbList[i], cList[i], &overflows, &cs);
       }
-      if ( go == 0 ) continue;
 
+      gettimeofday(&t2, NULL);
+      double seconds = (double)(t2.tv_usec - t1.tv_usec) / 1000000.0 + (double)(t2.tv_sec - t1.tv_sec);
+      if (seconds < bestSeconds[pass]) bestSeconds[pass] = seconds;
+    }
 
+    free(arrayk2packed);
+    tableFree(&tf);
 
+    speeds[k2] = (double)numbers / bestSeconds[0];
+    if (speeds[k2] > speeds[best]) best = k2;
+    if (passes == 2) printf("  %2i   %e   %e\n", k2, speeds[k2], (double)numbers / bestSeconds[1]);
+    else printf("  %2i   %e\n", k2, speeds[k2]);
+    fflush(stdout);
+  }
 
-      // Try another method to rule out the b...
-      //   Starting at b-1, compare the final b and c after k steps
-      // This will take more time, and will only rule out a few more b values
+  printf("  best k2 = %i\n", best);
 
-      __uint128_t bm = b - 1;
-      int cm = 0;
 
-      // take k steps to get bm and cm
-      for(j=0; j<k; j++) {
-        if (bm & 1) {
-          bm = 3*(bm/2) + 2;
-          cm++;
-        } else {
-          bm >>= 1;
-        }
-      }
 
-      // check bm and cm against bb and c
-      if ( bm == bb && cm == c ) {
-        continue;
-        //print128(b);
-        break;
-      }
+  /* save the profile */
 
+  FILE* fp = fopen(profile, "w");
+  if (!fp) {
+    printf("  error: cannot open %s!\n", profile);
+    return 0;
+  }
+  fprintf(fp, "# made by --tune of collatzPartiallySieveless_repeatedKsteps.c\n");
+  fprintf(fp, "# k2   numbers/second\n");
+  for (int k2 = tuneK2min; k2 <= k2max; k2++) fprintf(fp, "#  %2i   %e\n", k2, speeds[k2]);
+  fprintf(fp, "k2 = %i\n", best);
+  fclose(fp);
+  printf("  saved to %s\n", profile);
 
+  free(maxNs);
+  free(c3);
+  return 0;
+}
 
 
 
-      countB++;
+/*
+  What is the same for every task_id0 and task_id,
+    so that --worker only makes it once
+*/
+struct resident {
+  __uint128_t* c3;           // 3^c
+  __uint128_t* maxNs;        // max n that won't overflow when multiplied by 3^c
+  uint64_t c3small[21];      // 3^c for c <= k2 as 64-bit numbers for the SIMD lanes
+  struct sieveFile sf;       // the 2^k1 sieve
+  struct tableFile tf;
+  const uint64_t* arrayk2;   // the 2^k2 sieve
+  uint32_t* arrayk2packed;   // the same with 32-bit entries, or NULL (see makeArrayk2packed())
+};
 
-      aMod = 0;
 
-      // a trick for modNum == 9 to get b%9 faster
-      uint64_t r = 0;
-      r += (uint64_t)(b)        & 0xfffffffffffffff;
-      r += (uint64_t)(b >>  60) & 0xfffffffffffffff;
-      r += (uint64_t)(b >> 120);
-      bMod = r%9;
 
-      for (a=aStart; a<aEnd; a++) {    // loop over a before next b (interlacing for speed)
+// makes c3[], maxNs[], and arrayk2[], and opens the sieve file, returning 0 if it worked
+static int residentInit(struct resident* rs) {
 
+  const __uint128_t UINTmax = -1;                   // trick to get all bits to be 1
 
+  // 3^c = 2^(log2(3)*c) = 2^(1.585*c),
+  //    so c=80 is the max to fit in 128-bit numbers.
+  // Note that c3[0] = 3^0
+  //const int lenC3 = 81;  // for 128-bit numbers
+  const int lenC3 = k+1;
 
-          // do a 3^2 sieve
 
-          nMod = (aMod * kkMod + bMod) % modNum;
 
-          // iterate before the following possible continue
-          aMod++;
-          if (aMod == modNum) aMod = 0;
 
-          //if (nMod == 2) continue;    // modNum = 3
-          if (nMod == 2 || nMod == 4 || nMod == 5 || nMod == 8) {   // modNum = 9
-            continue;
-          }
+  int j;
 
 
 
 
-          nStart = (a<<k) + b;
 
-          n = a*c3[c] + bb;
+  // calculate lookup table for c3, which is 3^c
+  rs->c3 = (__uint128_t*)malloc(lenC3*sizeof(__uint128_t));
+  rs->c3[0] = 1;
+  for (j=1; j<lenC3; j++) { rs->c3[j] = rs->c3[j-1]*3; }
+
 
+  // defining max values is very important to detect overflow
+  // calculate lookup table for maxNs
+  rs->maxNs = (__uint128_t*)malloc(lenC3*sizeof(__uint128_t));
+  for (j=0; j<lenC3; j++) { rs->maxNs[j] = UINTmax / rs->c3[j]; }
 
-          /* do k2 steps at a time */
-          do {
-              size_t index = n & ( ((uint64_t)1<<k2) - 1 );  // get lowest k2 bits of n
-              uint64_t newB = arrayk2[index];
-              size_t newC = newB >> 58;    // just 6 bits gives c
-              newB &= 0x3ffffffffffffff;   // rest of bits gives b
+  for (j=0; j<21; j++) { rs->c3small[j] = (j<lenC3) ? (uint64_t)rs->c3[j] : 0; }
+
+
+
+
+
+  /* open the 2^k1 sieve file (see sieveFile.h) */
+
+  int sieveErr = sieveOpen(&rs->sf, file, k1);
+  if ( sieveErr == SIEVE_ERR_OPEN ) {
+    printf("  error: cannot open sieve file!\n");
+    return 1;
+  }
+  if ( sieveErr == SIEVE_ERR_RAM ) {
+    printf("  error: not enough RAM for sieve file!\n");
+    return 1;
+  }
+  if ( sieveErr ) {
+    printf("  error: wrong sieve file!\n");
+    return 1;
+  }
 
-              /* find the new n */
-              //n = (n >> k2)*c3[newC] + newB;
-              n >>= k2;
-              if (n > maxNs[newC]) {
-                  printf("Overflow! nStart = ");
-                  print128(nStart);
-                  break;
-              }
-              n *= c3[newC];
-              if (n > UINTmax - newB) {
-                  printf("Overflow! nStart = ");
-                  print128(nStart);
-                  break;
-              }
-              n += newB;
 
-              if (n < nStart) break;
-          } while (1);
 
-      }
 
+
+  ////////////////////////////////////////////////////////////////
+  //////// create arrayk2[] for the 2^k2 sieve
+  ////////////////////////////////////////////////////////////////
+
+  rs->arrayk2 = makeArrayk2(&rs->tf, k2, rs->c3);
+  rs->arrayk2packed = makeArrayk2packed(rs->arrayk2, k2);
+
+  return 0;
+}
+
+
+
+static void residentFree(struct resident* rs) {
+  free(rs->maxNs);
+  free(rs->c3);
+  free(rs->arrayk2packed);
+  tableFree(&rs->tf);
+  sieveClose(&rs->sf);
+}
+
+
+
+/*
+  Runs task_id <= id < task_idEnd of task_id0
+  Returns 0 if it ran, or 1 if these task_id cannot be run
+*/
+static int runTasks(struct resident* rs, const uint64_t task_id0, const uint64_t task_id, const uint64_t task_idEnd) {
+
+  const __uint128_t* c3 = rs->c3;
+  const __uint128_t* maxNs = rs->maxNs;
+  const uint64_t* c3small = rs->c3small;
+  const uint64_t* arrayk2 = rs->arrayk2;
+  const uint32_t* arrayk2packed = rs->arrayk2packed;
+
+  uint64_t maxTaskID = ((uint64_t)1 << (k - TASK_SIZE));
+  if ( task_id >= maxTaskID || task_idEnd > maxTaskID ) {
+    printf("Aborting. task_id must be less than ");
+    print128( maxTaskID );
+    return 1;
+  }
+  if ( task_idEnd <= task_id ) {
+    printf("Aborting. task_idEnd must be greater than task_id\n");
+    return 1;
+  }
+  const uint64_t numTasks = task_idEnd - task_id;
+  if ( task_id0Count < 1 ) {
+    printf("Aborting. task_id0Count > 0 must be true\n");
+    return 1;
+  }
+
+  printf("task_id0 = ");
+  print128(task_id0);
+  if ( task_id0Count > 1 ) {
+    printf("task_id0Count = ");
+    print128(task_id0Count);
+  }
+  printf("task_id = ");
+  print128(task_id);
+  if ( numTasks > 1 ) {
+    printf("task_idEnd = ");
+    print128(task_idEnd);
+  }
+  printf("task_id must be less than ");
+  print128(maxTaskID);
+  printf("TASK_SIZE = ");
+  print128(TASK_SIZE);
+  printf("TASK_SIZE0 = ");
+  print128(TASK_SIZE0);
+  printf("  k = %i\n", k);
+  printf("  k1 = %i\n", k1);
+  printf("  sieve file = %s\n", file);
+  printf("  k2 = %i\n", k2);
+#ifdef _OPENMP
+  printf("  threads = %i\n", omp_get_max_threads());
+#endif
+  fflush(stdout);
+
+
+
+
+  const __uint128_t UINTmax = -1;                   // trick to get all bits to be 1
+
+
+  if ( task_id0 + task_id0Count - 1 > ( (UINTmax / 9) >> (TASK_SIZE0 - k) ) - 1 ) {
+    printf("Error: Overflow!\n");
+    return 1;
+  }
+
+  // Code will test aStart <= a < aStart + aSteps
+  // Set this to 2^0 = 1 to have get an idea of how long processing the sieve takes.
+  // Ideally, I like to set this to at least 2^10.
+  const __uint128_t aSteps = (__uint128_t)9 << (TASK_SIZE0 - k);
+  const __uint128_t aStart = (__uint128_t)task_id0*9 << (TASK_SIZE0 - k);
+  const __uint128_t aEnd = aStart + aSteps;
+
+  // task_id0 + i has aStart + i*aSteps <= a < aEnd + i*aSteps (see --task_id0Count)
+  const __uint128_t aEndAll = aStart + aSteps*task_id0Count;
+
+
+  // Test a for overflow
+  // Note that after k steps for B = 2^k - 1, B will become 3^k - 1
+  //   and A*2^k will become A*3^k
+  const __uint128_t maxA = (UINTmax - c3[k] + 1) / c3[k];     // max a
+  if (aEndAll - 1 > maxA) {
+    printf("Error: a*2^k + (2^k - 1) will overflow after k steps!\n");
+    return 1;
+  }
+
+
+
+
+
+  gettimeofday(&tv1, NULL);    // start timer
+
+  // to count the numbers that need testing in each segment of 2^k sieve
+  uint64_t* countB = (uint64_t*)calloc(numTasks, sizeof(uint64_t));
+
+  // checksum and max n of each task_id if compiled with -DCHECKSUM (see collatzChecksum.h)
+  // cs[t*task_id0Count + i] is for task_id + t and task_id0 + i
+  const uint64_t numCs = numTasks * task_id0Count;
+  struct collatzChecksum* cs = (struct collatzChecksum*)malloc(numCs * sizeof(struct collatzChecksum));
+  for (uint64_t t = 0; t < numCs; t++) checksumInit(&cs[t]);
+  uint64_t* overflows = (uint64_t*)calloc(numCs, sizeof(uint64_t));    // like cs
+
+  // with --worker, the overflows of the tasks before are already printed
+  overflowListCount = 0;
+
+
+
+
+
+  /*
+    I will use the 2^k1 sieve for a batch of task_id at a time.
+    All threads read from this one part of the sieve.
+    Each task_id needs 2^(TASK_SIZE - 8) patterns, and each pattern is 2 bytes.
+    A batch is at most 2^24 bytes = 16 MiB unless a single task_id needs more.
+    A batch cannot go past the end of the sieve file,
+      which happens every 2^(k1 - TASK_SIZE) task_id.
+  */
+  const uint64_t patternsPerTask = (uint64_t)1 << (TASK_SIZE - 8);
+  const uint64_t tasksPerSieve = (uint64_t)1 << (k1 - TASK_SIZE);
+  uint64_t tasksPerBatch = ((uint64_t)1 << 23) / patternsPerTask;
+  if (tasksPerBatch < 1) tasksPerBatch = 1;
+
+
+
+
+
+  /*
+    Pick up from a checkpoint (see collatzCheckpoint.h)
+    Saved are how many patterns are done (counting from the first pattern of task_id),
+      then countB of each task_id, then each cs and its overflows
+    Since the threads finish patterns out of order, the patterns are run in pieces,
+      and a checkpoint can only be saved between pieces.
+    Without --checkpoint, a piece is a whole batch, so nothing changes.
+  */
+  const int cpCount = 1 + numTasks + 4*numCs;
+  __uint128_t* cpValues = (__uint128_t*)malloc(cpCount * sizeof(__uint128_t));
+  char cpID[512];
+  snprintf(cpID, sizeof(cpID), "partiallySieveless_repeatedKsteps k=%d k1=%d k2=%d TASK_SIZE=%d TASK_SIZE0=%d task_id0=%llu task_id0Count=%d task_id=%llu task_idEnd=%llu",
+      k, k1, k2, TASK_SIZE, TASK_SIZE0, (unsigned long long)task_id0, task_id0Count, (unsigned long long)task_id, (unsigned long long)task_idEnd);
+  struct checkpoint cp;
+  checkpointInit(&cp, checkpointFile, checkpointSeconds, cpID, task_id0, task_id);
+  uint64_t patternsDone = 0;
+  if ( checkpointLoad(&cp, cpValues, cpCount) ) {
+    patternsDone = (uint64_t)cpValues[0];
+    for (uint64_t t = 0; t < numTasks; t++) countB[t] = (uint64_t)cpValues[1 + t];
+    for (uint64_t t = 0; t < numCs; t++) {
+      cs[t].checksum = (uint64_t)cpValues[1 + numTasks + 4*t];
+      cs[t].maxN = cpValues[2 + numTasks + 4*t];
+      cs[t].maxNstart = cpValues[3 + numTasks + 4*t];
+      overflows[t] = (uint64_t)cpValues[4 + numTasks + 4*t];
     }
   }
+  const uint64_t patternsPerPiece = (uint64_t)1 << 12;
+
+
+
+
+
+  ////////////////////////////////////////////////////////////////
+  //////// test integers that aren't excluded by certain rules
+  ////////////////////////////////////////////////////////////////
+
+  uint64_t tasksThisBatch;
+  for (uint64_t batch = 0; batch < numTasks; batch += tasksThisBatch) {
+
+    uint64_t firstTask = (task_id + batch) % tasksPerSieve;   // first task_id within sieve file
+    tasksThisBatch = min(tasksPerBatch, numTasks - batch);
+    tasksThisBatch = min(tasksThisBatch, tasksPerSieve - firstTask);
+
+    // skip the patterns done before the checkpoint
+    const uint64_t iEnd = tasksThisBatch * patternsPerTask;
+    if ( batch * patternsPerTask + iEnd <= patternsDone ) continue;
+    const uint64_t iFirst = patternsDone > batch * patternsPerTask ? patternsDone - batch * patternsPerTask : 0;
+
+    /*
+      Get the part of the sieve file needed by the task_id of the batch
+      Note that the first pattern is ( bStart % 2^k1 ) / 256
+      data[0] is pattern iFirst of the batch
+    */
+    const uint16_t* data = sieveLoad(&rs->sf, firstTask * patternsPerTask + iFirst, iEnd - iFirst);
+    if (!data) {
+      printf("  error: cannot read sieve file! Aborting.\n");
+      free(countB);
+      free(cs);
+      free(overflows);
+      free(cpValues);
+      return 1;
+    }
+
+    const uint64_t piece = cp.file[0] ? patternsPerPiece : iEnd;
+    for (uint64_t iPiece = iFirst; iPiece < iEnd; iPiece += piece) {
+    const uint64_t iPieceEnd = min(iPiece + piece, iEnd);
+
+    // each iteration is a single 2-byte pattern of a single task_id
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for (uint64_t iPattern = iPiece; iPattern < iPieceEnd; iPattern++) {
+
+    uint64_t t = iPattern / patternsPerTask;      // which task_id of the batch
+    uint64_t pattern = iPattern % patternsPerTask;
+
+    __uint128_t bStart = ( (__uint128_t)1 << TASK_SIZE )*(task_id + batch + t);
+
+    uint16_t bytes = data[iPattern - iFirst];    // the current 2 bytes
+    uint64_t countBpattern = 0;
+    struct collatzChecksum csPattern[task_id0Count];
+    uint64_t overflowsPattern[task_id0Count];
+    for (int i = 0; i < task_id0Count; i++) {
+      checksumInit(&csPattern[i]);
+      overflowsPattern[i] = 0;
+    }
+
+    for (int bit = 0; bit < 16; bit ++) {      // loop over 16 bits in pattern
 
-  printf("  Numbers in sieve segment that needed testing = ");
-  print128(countB);
+      // allow the 2^k1 sieve to help!
+      if ( !( bytes & (1 << bit) ) ) continue;
+      //countB++;
+
+
+
+      __uint128_t b = bStart + pattern * 256 + sieveSmall[bit];
+
+      __uint128_t bb;      // will become fk(b)
+      int c;               // number of increases experienced when calculated fk(b)
+      if ( !stepB(b, &bb, &c) ) continue;
+
+      countBpattern++;
+
+      // each task_id0 (see --task_id0Count)
+      for (int i = 0; i < task_id0Count; i++)
+        testB(k2, arrayk2, arrayk2packed, c3, c3small, maxNs, aStart + i*aSteps, aEnd + i*aSteps, b, bb, c,
+            &overflowsPattern[i], &csPattern[i]);
+
+    }
+
+#ifdef _OPENMP
+    #pragma omp atomic
+#endif
+    countB[batch + t] += countBpattern;
+    for (int i = 0; i < task_id0Count; i++) {
+#ifdef _OPENMP
+      #pragma omp atomic
+#endif
+      overflows[(batch + t)*task_id0Count + i] += overflowsPattern[i];
+    }
+#ifdef CHECKSUM
+#ifdef _OPENMP
+    #pragma omp critical
+#endif
+    for (int i = 0; i < task_id0Count; i++) checksumAdd(&cs[(batch + t)*task_id0Count + i], &csPattern[i]);
+#endif
+
+    }
+
+    // save a checkpoint every so often
+    if ( batch * patternsPerTask + iPieceEnd < numTasks * patternsPerTask && checkpointDue(&cp) ) {
+      cpValues[0] = batch * patternsPerTask + iPieceEnd;
+      for (uint64_t t = 0; t < numTasks; t++) cpValues[1 + t] = countB[t];
+      for (uint64_t t = 0; t < numCs; t++) {
+        cpValues[1 + numTasks + 4*t] = cs[t].checksum;
+        cpValues[2 + numTasks + 4*t] = cs[t].maxN;
+        cpValues[3 + numTasks + 4*t] = cs[t].maxNstart;
+        cpValues[4 + numTasks + 4*t] = overflows[t];
+      }
+      checkpointSave(&cp, cpValues, cpCount);
+    }
+    }
+  }
+
+  for (uint64_t t = 0; t < numTasks; t++) {
+    if ( numTasks > 1 ) {
+      printf("task_id = ");
+      print128(task_id + t);
+    }
+    printf("  Numbers in sieve segment that needed testing = ");
+    print128(countB[t]);
+    for (int i = 0; i < task_id0Count; i++) {
+      if ( task_id0Count > 1 ) {
+        printf("task_id0 = ");
+        print128(task_id0 + i);
+      }
+      printf("  overflows = ");
+      print128(overflows[t*task_id0Count + i]);
+      checksumPrint(&cs[t*task_id0Count + i]);
+    }
+  }
 
   gettimeofday(&tv2, NULL);
-  printf("  %e seconds\n\n",
-      (double)(tv2.tv_usec - tv1.tv_usec) / 1000000.0 + (double)(tv2.tv_sec - tv1.tv_sec)); 
+  double seconds = (double)(tv2.tv_usec - tv1.tv_usec) / 1000000.0 + (double)(tv2.tv_sec - tv1.tv_sec);
+  printf("  %e seconds\n\n", seconds);
+
+  // the same results as JSON lines (see collatzJson.h)
+  // Each task_id and task_id0 gets an equal share of the seconds, so that seconds can be added up
+  for (uint64_t t = 0; jsonFile[0] && t < numCs; t++) {
+    const int i = t % task_id0Count;
+    __uint128_t bStart = ( (__uint128_t)1 << TASK_SIZE )*(task_id + t/task_id0Count);
+    struct jsonRecord j;
+    jsonStart(&j);
+    jsonString(&j, "code", "partiallySieveless_repeatedKsteps");
+    jsonInt(&j, "k", k);
+    jsonInt(&j, "k1", k1);
+    jsonInt(&j, "k2", k2);
+    jsonInt(&j, "deltaN", -1);
+    jsonInt(&j, "MOD3_POWER", MOD3_POWER);
+    jsonString(&j, "sieve", file);
+    jsonInt(&j, "TASK_SIZE", TASK_SIZE);
+    jsonInt(&j, "TASK_SIZE0", TASK_SIZE0);
+    jsonU128(&j, "task_id0", task_id0 + i);
+    jsonU128(&j, "task_id", task_id + t/task_id0Count);
+    jsonU128(&j, "countB", countB[t/task_id0Count]);
+    jsonU128(&j, "overflow_count", overflows[t]);
+    jsonChecksum(&j, &cs[t]);
+    jsonOverflows(&j, k, bStart, bStart + ((__uint128_t)1 << TASK_SIZE), aStart + i*aSteps, aEnd + i*aSteps);
+    jsonDouble(&j, "seconds", seconds / numCs);
+    if ( jsonWrite(&j, jsonFile) ) break;
+  }
+
+  checkpointRemove(&cp);
+
+  free(countB);
+  free(cs);
+  free(overflows);
+  free(cpValues);
+  return 0;
+}
+
+
+
+/*
+  For --worker
+  Instead of exiting after one task, reads lines from stdin such as...
+    0 5
+    0 6 10
+  and runs each as if they were the task_id0, task_id, and task_idEnd arguments.
+  After each line, prints "worker: done" or "worker: failed" then the line,
+    so that whatever is sending the lines knows when to read the results.
+  Stops at the end of stdin.
+*/
+static void runWorker(struct resident* rs) {
+  char line[256];
+  while ( fgets(line, sizeof(line), stdin) ) {
+    unsigned long long id0, id, idEnd;
+    int n = sscanf(line, "%llu %llu %llu", &id0, &id, &idEnd);
+    if (n < 1) continue;     // a blank line
+    if (n == 2) idEnd = id + 1;
+    int err = n < 2 || runTasks(rs, id0, id, idEnd);
+    line[strcspn(line, "\r\n")] = '\0';
+    printf("worker: %s %s\n", err ? "failed" : "done", line);
+    fflush(stdout);
+  }
+}
+
+
+
+int main(int argc, char *argv[]) {
+
+  char tuneFile[256] = "";
+
+  // --worker has no value, so take it out before reading the other options
+  int worker = 0;
+  for (int i = 1; i < argc; i++) {
+    if ( strcmp(argv[i], "--worker") ) continue;
+    worker = 1;
+    for (int j = i; j < argc; j++) argv[j] = argv[j+1];   // argv[argc] is NULL
+    argc--;
+    i--;
+  }
+
+  // read options such as --k2 13 (see collatzParams.h)
+  struct collatzParam params[] = {
+    {"k", &k, NULL, 0},
+    {"TASK_SIZE0", &TASK_SIZE0, NULL, 0},
+    {"TASK_SIZE", &TASK_SIZE, NULL, 0},
+    {"k2", &k2, NULL, 0},
+    {"k1", &k1, NULL, 0},
+    {"sieve", NULL, file, sizeof(file)},
+    {"tune", NULL, tuneFile, sizeof(tuneFile)},
+    {"json", NULL, jsonFile, sizeof(jsonFile)},
+    {"tables", NULL, tables, sizeof(tables)},
+    {"checkpoint", NULL, checkpointFile, sizeof(checkpointFile)},
+    {"checkpointSeconds", &checkpointSeconds, NULL, 0},
+    {"task_id0Count", &task_id0Count, NULL, 0},
+    {NULL, NULL, NULL, 0}
+  };
+  argc = paramsParse(params, argc, argv);
+  if ( argc < 0 || paramsCheck(k, k1, k2, TASK_SIZE, TASK_SIZE0) ) return 0;
+
+  if ( kstepsInit(&kt, KSTEPS_BITS) ) {
+    printf("  error: cannot make the k-steps table!\n");
+    return 0;
+  }
+  mod3Init(&m3, k);
+
+  // find the best k2 for this computer instead of running task_id
+  if ( tuneFile[0] ) return tuneK2(tuneFile);
+
+  if( !worker && argc < 3 ) {
+    printf("Too few arguments. Aborting.\n");
+    return 0;
+  }
+
+  // the tables and the sieve file used by every task
+  struct resident rs;
+  if ( residentInit(&rs) ) return 0;
+
+  if (worker) {
+    runWorker(&rs);
+  } else {
+
+    uint64_t task_id0 = (uint64_t)strtoull(argv[1], NULL, 10);
+
+    uint64_t task_id  = (uint64_t)strtoull(argv[2], NULL, 10);
+
+    // optional third argument to run task_id <= id < task_idEnd
+    uint64_t task_idEnd = task_id + 1;
+    if ( argc > 3 ) task_idEnd = (uint64_t)strtoull(argv[3], NULL, 10);
+
+    runTasks(&rs, task_id0, task_id, task_idEnd);
+  }
 
   // free memory (cuz why not?)
-  free(maxNs);
-  free(c3);
-  free(arrayk2);
+  residentFree(&rs);
+  kstepsFree(&kt);
   return 0;
 }
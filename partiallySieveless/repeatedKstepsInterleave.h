@@ -0,0 +1,155 @@
+/* ******************************************
+
+Tests all aStart <= a < aEnd for a single b by stepping many numbers in turn
+  for my CPU-only "repeated k steps" codes when the 2^k2 table is large
+
+Larger k2 means fewer steps per number, but arrayk2[] is 2^(k2 + 3) bytes,
+  so k2 = 18 is 2 MiB and k2 = 24 is 128 MiB.
+When the table doesn't fit in cache, almost every arrayk2[n & mask] must wait
+  for RAM, and the usual code can't start the next lookup until it has the last one,
+  since it steps one n until it drops below nStart before starting the next a.
+Instead, INTERLEAVE numbers (each with a different a) are kept going at once.
+Each gets one k2 step in turn, and, after each step, the table entry for its next step
+  is prefetched, so it is in cache by the time the other numbers have had their turn.
+When a number drops below its nStart (or overflows), the next a that isn't
+  excluded by the 3^m sieve (see collatzMod3.h) takes its place.
+This is like repeatedKstepsLanes.h, except each number is a normal __uint128_t,
+  so any k2 works, and the CPU itself does the numbers at the same time
+  since their steps don't depend on each other.
+
+On my CPU (2 MiB L2 cache), with 16 numbers at once...
+  k2 = 18 was a bit slower than the usual code, since the table still fits in L2
+  k2 = 19 was 1.4x faster, and was faster than the best k2 of the usual code
+  k2 = 22 and 24 were 3.6x faster (8 numbers at once were only 2.7x faster)
+It is used when k2 >= INTERLEAVE_K2, unless the SIMD lanes are used
+  (the lanes with a small k2 are still faster).
+The defaults can be changed when compiling, such as by...
+  gcc -O3 -DINTERLEAVE=32 -DINTERLEAVE_K2=20 collatzPartiallySieveless_repeatedKsteps.c
+To turn it off, compile with -DNO_INTERLEAVE
+Use --tune (see collatzPartiallySieveless_repeatedKsteps.c) to see if large k2 is now fastest.
+
+Before including this file, the host code must define print128()
+
+(c) 2021 Bradley Knockel
+
+****************************************** */
+
+
+#ifndef REPEATEDKSTEPSINTERLEAVE_H
+#define REPEATEDKSTEPSINTERLEAVE_H
+
+#include <stdint.h>
+
+#include "collatzOverflow256.h"
+#include "collatzChecksum.h"
+#include "collatzMod3.h"
+
+#ifndef NO_INTERLEAVE
+
+// how many numbers are stepped at once
+#ifndef INTERLEAVE
+#define INTERLEAVE 16
+#endif
+
+// the smallest k2 to use it for (k2 = 19 is a 4 MiB table)
+#ifndef INTERLEAVE_K2
+#define INTERLEAVE_K2 19
+#endif
+
+
+
+/*
+  Tests n = a*2^k + b for aStart <= a < aEnd that aren't excluded by the 3^m sieve
+  bb = fk(b), c = number of increases in first k steps, m3 has the tables of collatzMod3.h
+  Returns how many times k2 steps were done, and adds to overflows and cs
+*/
+static uint64_t testInterleaved(const uint64_t* arrayk2, const int k2,
+    const __uint128_t* c3, const __uint128_t* maxNs, const int k,
+    const __uint128_t aStart, const __uint128_t aEnd,
+    const __uint128_t b, const __uint128_t bb, const int c,
+    const struct mod3Sieve* m3, uint64_t* overflows, struct collatzChecksum* cs) {
+
+  const __uint128_t UINTmax = -1;                   // trick to get all bits to be 1
+  const uint64_t maskk2 = ((uint64_t)1 << k2) - 1;
+
+  // the numbers being stepped are in slots 0 to live - 1
+  __uint128_t n[INTERLEAVE], nStart[INTERLEAVE];
+  int live = 0;
+  uint64_t steps = 0;
+
+  __uint128_t a = aStart;
+  int nMod = mod3First(m3, &a, b);
+
+  for (; live < INTERLEAVE && a < aEnd; a += m3->skip[nMod], nMod = m3->next[nMod]) {
+    n[live] = a*c3[c] + bb;
+    nStart[live] = (a << k) + b;
+    __builtin_prefetch(&arrayk2[(uint64_t)n[live] & maskk2]);
+    CHECKSUM_ADD(cs, c);
+    live++;
+  }
+
+  while (live > 0) {
+    for (int j = 0; j < live; ) {
+
+      /* do k2 steps for slot j */
+
+      steps++;
+      __uint128_t x = n[j];
+      uint64_t newB = arrayk2[(uint64_t)x & maskk2];
+      size_t newC = newB >> 58;    // just 6 bits gives c
+      newB &= 0x3ffffffffffffff;   // rest of bits gives b
+
+      int done = 0;
+      x >>= k2;
+      if (x > maxNs[newC]) {
+        done = 1;
+      } else {
+        x *= c3[newC];
+        if (x > UINTmax - newB) done = 1;
+      }
+      if (done) {
+#ifdef _OPENMP
+        #pragma omp critical
+#endif
+        {
+        overflow256(nStart[j], arrayk2, k2);
+        }
+        (*overflows)++;
+      } else {
+        x += newB;
+        CHECKSUM_ADD(cs, k2);
+        CHECKSUM_MAX(cs, x, nStart[j]);
+        done = (x < nStart[j]);
+      }
+
+      if (!done) {
+        n[j] = x;
+        __builtin_prefetch(&arrayk2[(uint64_t)x & maskk2]);
+        j++;
+        continue;
+      }
+
+      /* slot j is done, so give it the next a, or else give it the last slot */
+
+      if (a < aEnd) {
+        n[j] = a*c3[c] + bb;
+        nStart[j] = (a << k) + b;
+        __builtin_prefetch(&arrayk2[(uint64_t)n[j] & maskk2]);
+        CHECKSUM_ADD(cs, c);
+        a += m3->skip[nMod];
+        nMod = m3->next[nMod];
+        j++;
+      } else {
+        live--;
+        n[j] = n[live];
+        nStart[j] = nStart[live];
+      }
+    }
+  }
+
+  return steps;
+}
+
+#endif
+
+#endif
@@ -0,0 +1,263 @@
+/* ******************************************
+
+Tests all aStart <= a < aEnd for a single b using SIMD lanes
+  for my CPU-only "repeated k steps" codes
+
+Instead of doing k2 steps at a time for one n until it drops below nStart,
+  LANES numbers (each with a different a) are stepped at the same time,
+  each in its own 64-bit lane of an AVX-512 register (8 lanes).
+When a lane's n drops below its nStart (or overflows), the lane is done,
+  and it is refilled with the next a that isn't excluded by the 3^m sieve (see collatzMod3.h).
+The numbers that pass the 3^m sieve are first put into a small buffer,
+  so that all done lanes can be refilled by a single instruction.
+
+SIMD has no 128-bit integers, so each n is split into two 64-bit halves,
+  much like my 128byHand codes, and each half is multiplied by 3^c
+  in 32-bit pieces.
+For this to work, 3^c must fit in 32 bits, so k2 < 21 is required.
+Overflow is found exactly as before, and overflow256() is used (see collatzOverflow256.h).
+If compiled with -DCHECKSUM, the checksum and max n are found too (see collatzChecksum.h).
+
+The lanes are only used if the compiler is told that the CPU has AVX-512,
+  such as by...
+  gcc -O3 -march=native collatzPartiallySieveless_repeatedKsteps.c
+Otherwise, LANES is not defined, and the usual one-at-a-time code is used.
+To turn off the lanes, compile with -DNO_LANES
+
+With k2 = 11, the lanes were about 1.6x faster than the usual code on my CPU.
+AVX2 (4 lanes) has no instruction to refill only some lanes,
+  and its gather is slow, so, for my CPU, 4 lanes were slower than the usual code.
+To try 4 lanes anyway, compile with -mavx2 -DAVX2_LANES
+
+Before including this file, the host code must define print128()
+
+(c) 2021 Bradley Knockel
+
+****************************************** */
+
+
+#ifndef REPEATEDKSTEPSLANES_H
+#define REPEATEDKSTEPSLANES_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "collatzOverflow256.h"
+#include "collatzChecksum.h"
+#include "collatzMod3.h"
+
+#if !defined(NO_LANES) && ( defined(__AVX512F__) || (defined(__AVX2__) && defined(AVX2_LANES)) )
+
+#include <immintrin.h>
+
+#ifdef __AVX512F__
+#define LANES 8
+#else
+#define LANES 4
+#endif
+
+typedef uint64_t vecU64 __attribute__((vector_size(8 * LANES)));
+
+
+
+// table[index] for each lane
+static inline vecU64 gatherLanes(const uint64_t* table, vecU64 index) {
+#ifdef __AVX512F__
+  return (vecU64)_mm512_i64gather_epi64((__m512i)index, (const long long*)table, 8);
+#else
+  return (vecU64)_mm256_i64gather_epi64((const long long*)table, (__m256i)index, 8);
+#endif
+}
+
+// (low 32 bits of x) * (low 32 bits of y) for each lane
+static inline vecU64 mul32Lanes(vecU64 x, vecU64 y) {
+#ifdef __AVX512F__
+  return (vecU64)_mm512_mul_epu32((__m512i)x, (__m512i)y);
+#else
+  return (vecU64)_mm256_mul_epu32((__m256i)x, (__m256i)y);
+#endif
+}
+
+// 1 bit per lane that is not 0
+static inline int anyLanes(vecU64 x) {
+#ifdef __AVX512F__
+  return _mm512_test_epi64_mask((__m512i)x, (__m512i)x);
+#else
+  return _mm256_movemask_pd((__m256d)x);
+#endif
+}
+
+
+
+// numbers waiting for a free lane
+#define LANES_BUFFER 512
+
+
+
+/*
+  Puts into lanes i with bit i of mask set the next numbers of the buffer
+  The buffer has LANES extra entries at the end, so this never reads past the end
+*/
+static inline vecU64 loadLanes(vecU64 x, int mask, const uint64_t* buffer) {
+#ifdef __AVX512F__
+  return (vecU64)_mm512_mask_expandloadu_epi64((__m512i)x, (__mmask8)mask, buffer);
+#else
+  for (int i = 0; i < LANES; i++) {
+    if ((mask >> i) & 1) x[i] = *buffer++;
+  }
+  return x;
+#endif
+}
+
+
+
+/*
+  Tests n = a*2^k + b for aStart <= a < aEnd that aren't excluded by the 3^m sieve
+  bb = fk(b), c = number of increases in first k steps, m3 has the tables of collatzMod3.h
+  c3small[j] = 3^j as uint64_t for j <= k2
+  Returns how many times k2 steps were done (one per lane), and adds to overflows and cs
+*/
+static uint64_t testLanes(const uint64_t* arrayk2, const int k2,
+    const __uint128_t* c3, const uint64_t* c3small, const int k,
+    const __uint128_t aStart, const __uint128_t aEnd,
+    const __uint128_t b, const __uint128_t bb, const int c,
+    const struct mod3Sieve* m3, uint64_t* overflows, struct collatzChecksum* cs) {
+
+  const uint64_t maskk2 = ((uint64_t)1 << k2) - 1;
+
+  /*
+    The numbers that pass the 3^m sieve are put into a buffer,
+      from which lanes are refilled.
+    An empty lane has n = 0 and nStart = 1, so it is always done.
+    Since nStart >= b > 1 for a real number, nStart = 1 marks an empty lane.
+  */
+  uint64_t bufLo[LANES_BUFFER + LANES], bufHi[LANES_BUFFER + LANES];
+  uint64_t bufSlo[LANES_BUFFER + LANES], bufShi[LANES_BUFFER + LANES];
+  int bufCount = 0;
+  int pos = 0;
+
+  // only the a that aren't excluded by the 3^m sieve
+  __uint128_t a = aStart;
+  int nMod = mod3First(m3, &a, b);
+
+  vecU64 lo, hi;       // n
+  vecU64 slo, shi;     // nStart
+  for (int i = 0; i < LANES; i++) { lo[i] = 0; hi[i] = 0; slo[i] = 1; shi[i] = 0; }
+  int doneBits = (1 << LANES) - 1;
+  uint64_t steps = 0;
+
+  while (1) {
+
+    /* refill done lanes */
+
+    if (pos + LANES > bufCount && a < aEnd) {
+
+      // move what is left to the front, then add the next numbers
+      int left = bufCount - pos;
+      for (int i = 0; i < left; i++) {
+        bufLo[i] = bufLo[pos + i];
+        bufHi[i] = bufHi[pos + i];
+        bufSlo[i] = bufSlo[pos + i];
+        bufShi[i] = bufShi[pos + i];
+      }
+      bufCount = left;
+      pos = 0;
+
+      for (; a < aEnd && bufCount < LANES_BUFFER; a += m3->skip[nMod], nMod = m3->next[nMod]) {
+        __uint128_t n = a*c3[c] + bb;
+        __uint128_t nStart = (a << k) + b;
+        bufLo[bufCount] = (uint64_t)n;
+        bufHi[bufCount] = (uint64_t)(n >> 64);
+        bufSlo[bufCount] = (uint64_t)nStart;
+        bufShi[bufCount] = (uint64_t)(nStart >> 64);
+        bufCount++;
+        CHECKSUM_ADD(cs, c);
+      }
+
+      // empty lanes for when the numbers run out
+      for (int i = bufCount; i < bufCount + LANES; i++) {
+        bufLo[i] = 0; bufHi[i] = 0; bufSlo[i] = 1; bufShi[i] = 0;
+      }
+    }
+
+    lo = loadLanes(lo, doneBits, bufLo + pos);
+    hi = loadLanes(hi, doneBits, bufHi + pos);
+    slo = loadLanes(slo, doneBits, bufSlo + pos);
+    shi = loadLanes(shi, doneBits, bufShi + pos);
+    pos += __builtin_popcount(doneBits);
+    if (pos > bufCount) pos = bufCount;    // the rest are empty
+
+    int activeBits = anyLanes((slo != 1) | shi);
+    if ( !activeBits ) break;   // all lanes are empty
+    steps += __builtin_popcount(activeBits);
+
+
+
+    /* do k2 steps at a time in every lane */
+
+    vecU64 newB = gatherLanes(arrayk2, lo & maskk2);
+    vecU64 newC = newB >> 58;       // just 6 bits gives c
+    newB &= 0x3ffffffffffffff;      // rest of bits gives b
+    vecU64 m = gatherLanes(c3small, newC);    // 3^newC < 2^32
+
+    // n >>= k2
+    lo = (lo >> k2) | (hi << (64 - k2));
+    hi >>= k2;
+
+    // n *= m in 32-bit pieces
+    vecU64 p0 = mul32Lanes(lo, m);
+    vecU64 p1 = mul32Lanes(lo >> 32, m);
+    vecU64 p2 = mul32Lanes(hi, m);
+    vecU64 p3 = mul32Lanes(hi >> 32, m);
+
+    vecU64 newLo = p0 + (p1 << 32);
+    vecU64 carry = (vecU64)(newLo < p0) & 1;
+    vecU64 newHi = p2 + (p1 >> 32) + carry;
+    vecU64 over = (vecU64)(newHi < p2);           // carry out of the top
+    vecU64 temp = newHi + (p3 << 32);
+    over |= (vecU64)(temp < newHi) | (vecU64)((p3 >> 32) != 0);
+    newHi = temp;
+
+    // n += newB
+    lo = newLo + newB;
+    carry = (vecU64)(lo < newLo) & 1;
+    hi = newHi + carry;
+    over |= (vecU64)(hi < newHi);
+
+    // if n < nStart, the lane is done
+    doneBits = anyLanes( (vecU64)(hi < shi) | ((vecU64)(hi == shi) & (vecU64)(lo < slo)) | over );
+
+    int overBits = anyLanes(over);
+    if (overBits) {
+      for (int i = 0; i < LANES; i++) {
+        if ( !((overBits >> i) & 1) ) continue;
+        (*overflows)++;
+#ifdef _OPENMP
+        #pragma omp critical
+#endif
+        {
+        overflow256( ((__uint128_t)shi[i] << 64) + slo[i], arrayk2, k2 );
+        }
+      }
+    }
+
+#ifdef CHECKSUM
+    // the lanes that did k2 steps without overflow
+    int okBits = activeBits & ~overBits;
+    CHECKSUM_ADD(cs, (uint64_t)k2 * __builtin_popcount(okBits));
+    vecU64 maxHi = (vecU64){0} + (uint64_t)(cs->maxN >> 64);
+    int bigBits = okBits & anyLanes( (vecU64)(hi >= maxHi) );    // lanes that could be a new max n
+    for (int i = 0; i < LANES; i++) {
+      if ( !((bigBits >> i) & 1) ) continue;
+      CHECKSUM_MAX(cs, ((__uint128_t)hi[i] << 64) + lo[i], ((__uint128_t)shi[i] << 64) + slo[i]);
+    }
+#endif
+
+  }
+
+  return steps;
+}
+
+#endif
+
+#endif
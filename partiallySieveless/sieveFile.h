@@ -0,0 +1,402 @@
+/* ******************************************
+
+Reads the 2^k1 sieve file made by collatzCreateSieve.c
+  or the compressed sieve file made by collatzCompressSieve.c
+
+Instead of each process doing its own fopen(), fseek(), and fread() into
+  its own buffer, the sieve file is memory mapped read-only.
+The operating system then keeps only one copy of the sieve in RAM (in its
+  page cache), and this copy is shared by every process that uses the sieve.
+Nothing is copied: the hosts read the 2-byte patterns straight from the map.
+Before a segment is used, madvise() tells the operating system that it will
+  be read sequentially soon, so it gets read ahead of time.
+
+On systems without mmap() (Windows), the segment is instead read into a buffer.
+
+A compressed sieve file is also memory mapped, but only the blocks of patterns
+  needed for the requested segment are decoded (into a buffer).
+The whole sieve is never decompressed.
+The file type is found from the first bytes of the file, so a host just
+  needs to be given the name of the compressed file.
+
+Use it via...
+  #include "sieveFile.h"
+
+  struct sieveFile sf;
+  if ( sieveOpen(&sf, "sieve37", 37) ) { error }
+  const uint16_t* patterns = sieveLoad(&sf, firstPattern, count);
+  ... patterns[0] to patterns[count - 1] ...
+  sieveClose(&sf);
+
+The pointer from sieveLoad() is valid until the next sieveLoad() or sieveClose().
+The patterns of sieveLoad() must not go past the end of the sieve file, which
+  is never an issue for the 2^TASK_SIZE segment of a task_id since TASK_SIZE <= k1.
+For the 2^TASK_SIZE segment that starts at bStart, use...
+  firstPattern = ( bStart % 2^k1 ) / 256
+  count = 2^(TASK_SIZE - 8)
+
+
+
+The compressed format...
+  The 2-byte patterns are Huffman coded: the common patterns (such as 0)
+    get short codes, and the rare ones get long codes.
+  The distinct patterns form the dictionary, which is stored in the file
+    along with the number of codes of each length (a canonical Huffman code).
+  The patterns are split into blocks of 2^blockLog2 patterns,
+    and the bit at which each block starts is stored so that any block
+    can be decoded without decoding the blocks before it.
+  All integers are in the byte order of the computer that made the file (little endian
+    on x86 and ARM), since they are read in place. A file from a computer of the other
+    byte order fails the version check, so compress the sieve again on that computer.
+  The header has a hash of the payload, which is checked when the file is opened,
+    so a damaged file is not used (this reads the whole compressed file once).
+  A code that isn't in the dictionary or that runs past its block makes sieveLoad() return NULL.
+  The file is...
+    struct sieveHufHeader
+    uint16_t symbols[symbols]        (dictionary in canonical order, padded to 8 bytes)
+    uint64_t offsets[blocks + 1]     (bit offset of each block in the payload)
+    uint8_t  payload[]               (the codes, most significant bit first)
+
+Works for C and C++
+
+(c) 2021 Bradley Knockel
+
+****************************************** */
+
+
+#ifndef SIEVEFILE_H
+#define SIEVEFILE_H
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// 64-bit file offsets, since a long is only 32 bits on Windows and sieve files can be over 2 GiB
+#ifdef _WIN32
+#define sieveSeek _fseeki64
+#define sieveTell _ftelli64
+#else
+#define sieveSeek fseeko
+#define sieveTell ftello
+#endif
+
+
+
+// return values of sieveOpen()
+#define SIEVE_OK 0
+#define SIEVE_ERR_OPEN 1    // cannot open file
+#define SIEVE_ERR_SIZE 2    // file size (or compressed header) does not match k1
+#define SIEVE_ERR_RAM 3     // not enough RAM to read the compressed file
+
+
+
+/* for the compressed format */
+
+#define SIEVEHUF_MAGIC "SIEVEHUF"
+#define SIEVEHUF_VERSION 2
+#define SIEVEHUF_MAXLEN 32     // longest allowed code
+
+struct sieveHufHeader {
+  char magic[8];                           // SIEVEHUF_MAGIC
+  uint32_t version;                        // SIEVEHUF_VERSION
+  uint32_t k1;
+  uint32_t blockLog2;                      // 2^blockLog2 patterns per block
+  uint32_t maxLen;                         // longest code
+  uint32_t symbols;                        // number of distinct patterns
+  uint32_t counts[SIEVEHUF_MAXLEN + 1];    // counts[len] is how many codes have length len
+  uint64_t payloadHash;                    // sieveHufHash() of the payload
+};
+
+/*
+  A quick hash of n bytes, 8 at a time (the last bytes are padded with 0)
+  Start with h = SIEVEHUF_HASH_START. Calling it on 8 bytes at a time,
+    then on the last bytes, gives the same hash as calling it on all of them.
+*/
+#define SIEVEHUF_HASH_START 14695981039346656037ULL
+static uint64_t sieveHufHash(uint64_t h, const uint8_t* bytes, size_t n) {
+  for (size_t i = 0; i < n; i += 8) {
+    uint64_t w = 0;
+    memcpy(&w, bytes + i, n - i < 8 ? n - i : 8);
+    h = (h ^ w) * 1099511628211ULL;
+  }
+  return h;
+}
+
+// where the parts of a compressed file start (in bytes)
+static void sieveHufLayout(const struct sieveHufHeader* h,
+    size_t* symbolsStart, size_t* offsetsStart, size_t* payloadStart) {
+  uint64_t blocks = (uint64_t)1 << (h->k1 - 8 - h->blockLog2);
+  *symbolsStart = sizeof(struct sieveHufHeader);
+  *offsetsStart = *symbolsStart + (((size_t)h->symbols * sizeof(uint16_t) + 7) & ~(size_t)7);
+  *payloadStart = *offsetsStart + (blocks + 1) * sizeof(uint64_t);
+}
+
+
+
+struct sieveFile {
+  int k1;
+  uint64_t patternCount;      // 2^(k1 - 8) patterns of 2 bytes each
+  size_t fileBytes;           // 2^(k1 - 7) unless compressed
+
+  const uint16_t* map;        // the whole file if memory mapped and not compressed, else NULL
+
+  FILE* fp;                   // only if not memory mapped and not compressed
+  uint16_t* buffer;           // if not memory mapped or if compressed
+  uint64_t bufferCount;       // patterns that buffer[] can hold
+
+  // only if compressed
+  const uint8_t* zFile;       // the whole compressed file
+  int zMapped;                // 1 if zFile is memory mapped, 0 if malloc'ed
+  struct sieveHufHeader zHeader;
+  const uint16_t* zSymbols;
+  const uint64_t* zOffsets;
+  const uint8_t* zPayload;
+};
+
+
+
+// checks the header of a compressed file that is in RAM
+static int sieveHufCheck(struct sieveFile* s) {
+  if (s->fileBytes < sizeof(struct sieveHufHeader)) return SIEVE_ERR_SIZE;
+  memcpy(&s->zHeader, s->zFile, sizeof(struct sieveHufHeader));
+  const struct sieveHufHeader* h = &s->zHeader;
+  if ( h->version != SIEVEHUF_VERSION || (int)h->k1 != s->k1 || h->maxLen > SIEVEHUF_MAXLEN
+      || h->blockLog2 > h->k1 - 8 ) return SIEVE_ERR_SIZE;
+
+  size_t symbolsStart, offsetsStart, payloadStart;
+  sieveHufLayout(h, &symbolsStart, &offsetsStart, &payloadStart);
+  if (payloadStart > s->fileBytes) return SIEVE_ERR_SIZE;
+  s->zSymbols = (const uint16_t*)(s->zFile + symbolsStart);
+  s->zOffsets = (const uint64_t*)(s->zFile + offsetsStart);
+  s->zPayload = s->zFile + payloadStart;
+
+  // every code must have a pattern in the dictionary
+  uint64_t codes = 0;
+  for (uint32_t len = 0; len <= SIEVEHUF_MAXLEN; len++) codes += h->counts[len];
+  if ( codes != h->symbols || h->counts[0] ) return SIEVE_ERR_SIZE;
+
+  uint64_t blocks = (uint64_t)1 << (h->k1 - 8 - h->blockLog2);
+  for (uint64_t block = 0; block < blocks; block++)
+    if ( s->zOffsets[block] > s->zOffsets[block + 1] ) return SIEVE_ERR_SIZE;
+  size_t payloadBytes = (s->zOffsets[blocks] + 7) / 8;
+  if ( payloadBytes > s->fileBytes - payloadStart ) return SIEVE_ERR_SIZE;
+  if ( sieveHufHash(SIEVEHUF_HASH_START, s->zPayload, payloadBytes) != h->payloadHash ) return SIEVE_ERR_SIZE;
+  return SIEVE_OK;
+}
+
+
+
+static int sieveOpen(struct sieveFile* s, const char* filename, int k1) {
+
+  s->k1 = k1;
+  s->patternCount = (uint64_t)1 << (k1 - 8);
+  s->fileBytes = (size_t)1 << (k1 - 7);
+  s->map = NULL;
+  s->fp = NULL;
+  s->buffer = NULL;
+  s->bufferCount = 0;
+  s->zFile = NULL;
+  s->zMapped = 0;
+
+  char magic[8] = {0};
+
+#ifndef _WIN32
+
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0) return SIEVE_ERR_OPEN;
+
+  struct stat st;
+  if ( fstat(fd, &st) ) {
+    close(fd);
+    return SIEVE_ERR_OPEN;
+  }
+
+  // is it compressed?
+  if ( read(fd, magic, 8) == 8 && memcmp(magic, SIEVEHUF_MAGIC, 8) == 0 ) {
+    s->fileBytes = st.st_size;
+    void* map = mmap(NULL, s->fileBytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return SIEVE_ERR_OPEN;
+    s->zFile = (const uint8_t*)map;
+    s->zMapped = 1;
+    return sieveHufCheck(s);
+  }
+
+  // Check file size
+  if ( (size_t)st.st_size != s->fileBytes ) {
+    close(fd);
+    return SIEVE_ERR_SIZE;
+  }
+
+  // MAP_SHARED so that all processes share the page cache
+  void* map = mmap(NULL, s->fileBytes, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);    // the map stays valid after closing
+  if (map != MAP_FAILED) {
+    s->map = (const uint16_t*)map;
+    return SIEVE_OK;
+  }
+
+#endif
+
+  // fall back to reading the file
+  s->fp = fopen(filename, "rb");
+  if (!s->fp) return SIEVE_ERR_OPEN;
+
+  // is it compressed? If so, read the whole compressed file into RAM
+  int compressed = ( fread(magic, 1, 8, s->fp) == 8 && memcmp(magic, SIEVEHUF_MAGIC, 8) == 0 );
+
+  int64_t bytes = -1;
+  if ( sieveSeek(s->fp, 0, SEEK_END) == 0 ) bytes = (int64_t)sieveTell(s->fp);
+  if ( bytes < 0 || (!compressed && (uint64_t)bytes != s->fileBytes) ) {
+    fclose(s->fp);
+    s->fp = NULL;
+    return SIEVE_ERR_SIZE;
+  }
+
+  // if compressed, read the whole compressed file into RAM
+  if (compressed) {
+    s->fileBytes = bytes;
+    uint8_t* file = (uint8_t*)malloc(s->fileBytes);
+    size_t got = 0;
+    if ( file && sieveSeek(s->fp, 0, SEEK_SET) == 0 ) got = fread(file, 1, s->fileBytes, s->fp);
+    fclose(s->fp);
+    s->fp = NULL;
+    if (!file) return SIEVE_ERR_RAM;
+    s->zFile = file;
+    if (got != s->fileBytes) return SIEVE_ERR_SIZE;
+    return sieveHufCheck(s);
+  }
+
+  return SIEVE_OK;
+}
+
+
+
+/*
+  Decodes patterns firstPattern <= pattern < firstPattern + count of a compressed file
+  The whole last block is decoded so that its codes can be checked to end where the next block starts
+  Returns 1 if a code isn't in the dictionary or if the codes don't end where they should, else 0
+*/
+static int sieveHufDecode(struct sieveFile* s, uint64_t firstPattern, uint64_t count, uint16_t* out) {
+
+  const struct sieveHufHeader* h = &s->zHeader;
+  uint64_t block = firstPattern >> h->blockLog2;
+  uint64_t lastBlock = (firstPattern + count - 1) >> h->blockLog2;
+  uint64_t skip = firstPattern - (block << h->blockLog2);   // patterns to decode before firstPattern
+
+  uint64_t bitPos = s->zOffsets[block];
+  uint64_t bitEnd = s->zOffsets[lastBlock + 1];
+  const uint8_t* p = s->zPayload + (bitPos >> 3);
+  const uint8_t* end = s->zPayload + ((bitEnd + 7) >> 3);
+
+#ifndef _WIN32
+  if (s->zMapped) {
+    // madvise() needs an address that is a multiple of the page size
+    uintptr_t pageMask = (uintptr_t)sysconf(_SC_PAGESIZE) - 1;
+    uintptr_t startPage = (uintptr_t)p & ~pageMask;
+    madvise((void*)startPage, (uintptr_t)end - startPage, MADV_WILLNEED);
+  }
+#endif
+
+  if (p >= end) return 1;
+  uint32_t byte = *p++;
+  int bitsLeft = 8 - (bitPos & 7);    // bits not yet used in byte
+
+  const uint64_t total = (lastBlock + 1 - block) << h->blockLog2;   // patterns to decode
+  for (uint64_t i = 0; i < total; i++) {
+
+    // canonical Huffman decoding
+    uint32_t code = 0;    // the bits read so far
+    uint32_t first = 0;   // first code of length len
+    uint32_t index = 0;   // index of first code of length len in zSymbols
+    uint32_t len;
+    for (len = 1; len <= h->maxLen; len++) {
+      if (bitsLeft == 0) {
+        if (p >= end) return 1;
+        byte = *p++;
+        bitsLeft = 8;
+      }
+      bitsLeft--;
+      code |= (byte >> bitsLeft) & 1;
+      uint32_t countLen = h->counts[len];
+      if (code - first < countLen) {
+        if (i >= skip && i < skip + count) out[i - skip] = s->zSymbols[index + (code - first)];
+        break;
+      }
+      index += countLen;
+      first += countLen;
+      first <<= 1;
+      code <<= 1;
+    }
+    if (len > h->maxLen) return 1;    // no code matched
+
+  }
+
+  // the codes must end exactly where the next block starts
+  return ( (uint64_t)(p - s->zPayload) * 8 - bitsLeft != bitEnd );
+}
+
+
+
+// returns pointer to patterns firstPattern <= pattern < firstPattern + count
+static const uint16_t* sieveLoad(struct sieveFile* s, uint64_t firstPattern, uint64_t count) {
+
+  if (s->map) {
+
+#ifndef _WIN32
+    // madvise() needs an address that is a multiple of the page size
+    uintptr_t pageMask = (uintptr_t)sysconf(_SC_PAGESIZE) - 1;
+    uintptr_t start = (uintptr_t)(s->map + firstPattern);
+    uintptr_t end = (uintptr_t)(s->map + firstPattern + count);
+    uintptr_t startPage = start & ~pageMask;
+    madvise((void*)startPage, end - startPage, MADV_SEQUENTIAL);
+    madvise((void*)startPage, end - startPage, MADV_WILLNEED);
+#endif
+
+    return s->map + firstPattern;
+  }
+
+  if (count > s->bufferCount) {
+    free(s->buffer);
+    s->buffer = (uint16_t*)malloc(count * sizeof(uint16_t));
+    s->bufferCount = s->buffer ? count : 0;
+    if (!s->buffer) return NULL;
+  }
+
+  if (s->zFile) {
+    if ( sieveHufDecode(s, firstPattern, count, s->buffer) ) return NULL;
+    return s->buffer;
+  }
+
+  if ( sieveSeek(s->fp, (int64_t)(firstPattern * sizeof(uint16_t)), SEEK_SET) ) return NULL;
+  if ( fread(s->buffer, sizeof(uint16_t), count, s->fp) != count ) return NULL;
+  return s->buffer;
+}
+
+
+
+static void sieveClose(struct sieveFile* s) {
+#ifndef _WIN32
+  if (s->map) munmap((void*)s->map, s->fileBytes);
+  if (s->zFile && s->zMapped) munmap((void*)s->zFile, s->fileBytes);
+#endif
+  if (s->zFile && !s->zMapped) free((void*)s->zFile);
+  if (s->fp) fclose(s->fp);
+  free(s->buffer);
+  s->map = NULL;
+  s->zFile = NULL;
+  s->fp = NULL;
+  s->buffer = NULL;
+}
+
+
+
+#endif
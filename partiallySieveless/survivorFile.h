@@ -0,0 +1,325 @@
+/* ******************************************
+
+Saves the b of a task_id that need testing to a file, so that the sieveless codes
+  only make each segment of the 2^k sieve once
+
+For the sieveless codes, each task_id is a segment of the 2^k sieve, and making the
+  segment (k steps for each b, then the deltaN check) is done again for every task_id0
+  even though only the a values change.
+For large k, making the sieve is much of the time, so, if run with --survivors folder,
+  the first run of a task_id saves each b that needs testing, along with
+  bb = fk(b) and c (the number of increases in the first k steps),
+  then every task_id0 after that just reads them.
+This is like having a 2^k sieve file, but it is made as you go,
+  and each task_id has its own file that can be deleted when that task_id is done.
+Each b is 24 bytes, so, for k=51 and TASK_SIZE=20, each file is about 60 KiB,
+  and all 2^31 files of a whole 2^51 sieve would need about 128 TiB!
+So only use this if you will run many task_id0 for the same few task_id.
+
+The file is...
+  struct survivorFileHeader    (which segment, how many b, and a checksum)
+  struct survivor list[count]  (in order of b)
+A file for different k, TASK_SIZE, or deltaN, or that is damaged, is made again.
+Like tableFile.h, the file is written to a temporary file then renamed,
+  and the file is memory mapped when read (or read into RAM on Windows).
+Only a run that starts at the first b of the task_id can save the file,
+  so a run that picked up from a checkpoint doesn't.
+
+Usage...
+  struct survivorFile sv;
+  survivorOpen(&sv, folder, k, TASK_SIZE, deltaN, task_id, canWrite);
+  if (sv.reading) {
+    survivorSeek(&sv, bFirst - bStart);
+    while ( survivorNext(&sv, bStart, &b, &bb, &c) ) ... test b ...
+  } else {
+    ... for each b that needs testing, survivorAdd(&sv, b - bStart, bb, c) ...
+    survivorFinish(&sv, excludedReduce, excludedJoin);
+  }
+  survivorClose(&sv);
+If folder is "", nothing is read or written.
+
+Works for C and C++
+
+(c) 2021 Bradley Knockel
+
+****************************************** */
+
+
+#ifndef SURVIVORFILE_H
+#define SURVIVORFILE_H
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <process.h>
+#endif
+
+
+
+#define SURVIVORFILE_MAGIC "COLLATZV"
+#define SURVIVORFILE_VERSION 1
+
+struct survivorFileHeader {
+  char magic[8];          // SURVIVORFILE_MAGIC
+  uint32_t version;       // SURVIVORFILE_VERSION
+  uint32_t k;
+  uint32_t TASK_SIZE;
+  uint32_t unused;
+  uint64_t deltaN;
+  uint64_t task_id;
+  uint64_t count;         // how many b need testing
+  uint64_t reduced;       // b ruled out by reducing in k steps
+  uint64_t joined;        // b ruled out by joining a path (deltaN)
+  uint64_t checksum;      // of the list
+};                        // 72 bytes
+
+struct survivor {
+  uint64_t bc;            // b - bStart in the lower 56 bits and c in the upper 8 bits
+  uint64_t bbLo;          // bb = fk(b)
+  uint64_t bbHi;
+};
+
+
+
+struct survivorFile {
+  struct survivorFileHeader h;
+  int reading;            // 1 if the list came from the file
+  int writing;            // 1 if the list is being saved
+  const struct survivor* list;
+  uint64_t next;          // the next b of the list to read
+  void* map;              // the whole file if reading, else NULL
+  size_t mapBytes;
+  FILE* out;
+  uint64_t hash;          // checksum of what is written so far
+  char file[600];
+  char tmp[620];
+};
+
+
+
+// a quick hash of the 64-bit words, like in tableFile.h
+static inline uint64_t survivorHash(uint64_t h, const struct survivor* s) {
+  h = (h ^ s->bc) * 1099511628211ULL;
+  h = (h ^ s->bbLo) * 1099511628211ULL;
+  h = (h ^ s->bbHi) * 1099511628211ULL;
+  return h;
+}
+
+
+
+static void survivorClose(struct survivorFile* sv) {
+  if (sv->map) {
+#ifndef _WIN32
+    munmap(sv->map, sv->mapBytes);
+#else
+    free(sv->map);
+#endif
+  }
+  sv->map = NULL;
+  sv->list = NULL;
+  sv->reading = 0;
+
+  // a file that wasn't finished is useless
+  if (sv->out) {
+    fclose(sv->out);
+    remove(sv->tmp);
+  }
+  sv->out = NULL;
+  sv->writing = 0;
+}
+
+
+
+// returns 1 if the file has the list of this segment, putting it in sv->list
+static int survivorLoad(struct survivorFile* sv, const struct survivorFileHeader* want) {
+
+  sv->map = NULL;
+  sv->mapBytes = 0;
+
+#ifndef _WIN32
+
+  int fd = open(sv->file, O_RDONLY);
+  if (fd < 0) return 0;
+  struct stat st;
+  if ( fstat(fd, &st) || (size_t)st.st_size < sizeof(*want) ) {
+    close(fd);
+    return 0;
+  }
+  void* map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);    // the map stays valid after closing
+  if (map == MAP_FAILED) return 0;
+  sv->map = map;
+  sv->mapBytes = st.st_size;
+
+#else
+
+  FILE* fp = fopen(sv->file, "rb");
+  if (!fp) return 0;
+  fseek(fp, 0, SEEK_END);
+  long size = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+  sv->map = size >= (long)sizeof(*want) ? malloc(size) : NULL;
+  if ( sv->map && fread(sv->map, 1, size, fp) != (size_t)size ) {
+    free(sv->map);
+    sv->map = NULL;
+  }
+  fclose(fp);
+  if (!sv->map) return 0;
+  sv->mapBytes = size;
+
+#endif
+
+  // is it the file of this segment?
+  memcpy(&sv->h, sv->map, sizeof(sv->h));
+  struct survivorFileHeader h = sv->h;
+  h.count = want->count;
+  h.reduced = want->reduced;
+  h.joined = want->joined;
+  h.checksum = want->checksum;
+  int good = !memcmp(&h, want, sizeof(h))
+      && sv->mapBytes == sizeof(h) + sv->h.count * sizeof(struct survivor);
+
+  // is it damaged?
+  sv->list = (const struct survivor*)((char*)sv->map + sizeof(h));
+  uint64_t hash = 14695981039346656037ULL;
+  for (uint64_t i = 0; good && i < sv->h.count; i++) hash = survivorHash(hash, &sv->list[i]);
+  good = good && hash == sv->h.checksum;
+
+  if (!good) {
+    printf("  survivors file %s is for a different segment or is damaged, so making it again\n", sv->file);
+    survivorClose(sv);
+    return 0;
+  }
+  return 1;
+}
+
+
+
+/*
+  Reads the file of this task_id from folder if it has one (sv->reading is then 1),
+    else, if canWrite, starts saving it (sv->writing is then 1)
+*/
+static void survivorOpen(struct survivorFile* sv, const char* folder, const int k, const int TASK_SIZE,
+    const uint64_t deltaN, const uint64_t task_id, const int canWrite) {
+
+  memset(sv, 0, sizeof(*sv));
+  if ( !folder[0] ) return;
+  if ( TASK_SIZE > 56 ) {
+    printf("  warning: --survivors needs TASK_SIZE <= 56, so it isn't used\n");
+    return;
+  }
+
+  snprintf(sv->file, sizeof(sv->file), "%s/survivors_%d_%d_%llu_%llu", folder, k, TASK_SIZE,
+      (unsigned long long)deltaN, (unsigned long long)task_id);
+
+  struct survivorFileHeader want;
+  memset(&want, 0, sizeof(want));
+  memcpy(want.magic, SURVIVORFILE_MAGIC, 8);
+  want.version = SURVIVORFILE_VERSION;
+  want.k = k;
+  want.TASK_SIZE = TASK_SIZE;
+  want.deltaN = deltaN;
+  want.task_id = task_id;
+
+  if ( survivorLoad(sv, &want) ) {
+    sv->reading = 1;
+    printf("  reading the b that need testing from %s\n", sv->file);
+    fflush(stdout);
+    return;
+  }
+  if (!canWrite) return;
+
+  // a temporary file for each process, so processes don't write to the same file
+#ifndef _WIN32
+  snprintf(sv->tmp, sizeof(sv->tmp), "%s.%d.tmp", sv->file, (int)getpid());
+#else
+  snprintf(sv->tmp, sizeof(sv->tmp), "%s.%d.tmp", sv->file, (int)_getpid());
+#endif
+  sv->out = fopen(sv->tmp, "wb");
+  if ( !sv->out || fwrite(&want, sizeof(want), 1, sv->out) != 1 ) {
+    printf("  error: cannot write survivors file %s!\n", sv->tmp);
+    survivorClose(sv);
+    return;
+  }
+  sv->h = want;
+  sv->hash = 14695981039346656037ULL;
+  sv->writing = 1;
+}
+
+
+
+// when reading, skips the b before bStart + offset (for picking up from a checkpoint)
+static void survivorSeek(struct survivorFile* sv, const uint64_t offset) {
+  const uint64_t mask = ((uint64_t)1 << 56) - 1;
+  uint64_t lo = 0, hi = sv->h.count;    // the list is in order of b
+  while (lo < hi) {
+    uint64_t mid = lo + (hi - lo) / 2;
+    if ( (sv->list[mid].bc & mask) < offset ) lo = mid + 1;
+    else hi = mid;
+  }
+  sv->next = lo;
+}
+
+
+
+// when reading, gets the next b, returning 0 if there are no more
+static inline int survivorNext(struct survivorFile* sv, const __uint128_t bStart,
+    __uint128_t* b, __uint128_t* bb, int* c) {
+  if (sv->next >= sv->h.count) return 0;
+  const struct survivor* s = &sv->list[sv->next++];
+  *b = bStart + (s->bc & (((uint64_t)1 << 56) - 1));
+  *c = (int)(s->bc >> 56);
+  *bb = ((__uint128_t)s->bbHi << 64) | s->bbLo;
+  return 1;
+}
+
+
+
+// when writing, adds a b that needs testing
+static inline void survivorAdd(struct survivorFile* sv, const uint64_t offset, const __uint128_t bb, const int c) {
+  if (!sv->writing) return;
+  struct survivor s;
+  s.bc = offset | ((uint64_t)c << 56);
+  s.bbLo = (uint64_t)bb;
+  s.bbHi = (uint64_t)(bb >> 64);
+  sv->hash = survivorHash(sv->hash, &s);
+  sv->h.count++;
+  if ( fwrite(&s, sizeof(s), 1, sv->out) != 1 ) {
+    printf("  error: cannot write survivors file %s!\n", sv->tmp);
+    survivorClose(sv);
+  }
+}
+
+
+
+// when writing, saves the file after the last b, returning 0 if it worked
+static int survivorFinish(struct survivorFile* sv, const uint64_t reduced, const uint64_t joined) {
+  if (!sv->writing) return 0;
+
+  sv->h.reduced = reduced;
+  sv->h.joined = joined;
+  sv->h.checksum = sv->hash;
+  int err = fseek(sv->out, 0, SEEK_SET) || fwrite(&sv->h, sizeof(sv->h), 1, sv->out) != 1;
+  err |= fclose(sv->out);
+  sv->out = NULL;
+  sv->writing = 0;
+#ifdef _WIN32
+  if (!err) remove(sv->file);     // rename() doesn't replace a file on Windows
+#endif
+  if ( err || rename(sv->tmp, sv->file) ) {
+    remove(sv->tmp);
+    printf("  error: cannot save survivors file %s!\n", sv->file);
+    return 1;
+  }
+  return 0;
+}
+
+#endif
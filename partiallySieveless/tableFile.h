@@ -0,0 +1,231 @@
+/* ******************************************
+
+Saves lookup tables such as arrayk2[] to a file, so that they are made only once
+
+Making the 2^k2 table arrayk2[] is very fast for k2 = 11, but, for the
+  k2 = 18 to 24 that GPUs like, it takes seconds, and it was done again
+  for each of thousands of short tasks.
+Instead, the first run saves the table to a file, and every run after that
+  memory maps the file read-only, like sieveFile.h does for the sieve.
+The operating system then keeps only one copy of the table in RAM (in its
+  page cache), and this copy is shared by every process that uses the table.
+
+The file has a header that says which table it is...
+  kind is a name for the table and how it counts steps,
+    such as "arrayk2 d+(c<<58)", so that a table made a different way is never used
+  k2, the size of each entry, and a checksum of the table
+A file with the wrong header or checksum is made again.
+Checking the checksum only reads the table once, which is much faster than making it.
+The file is written to a temporary file then renamed, so many processes can start
+  at once without any of them seeing half of a file.
+
+On systems without mmap() (Windows), the table is instead read into RAM.
+
+Use it via...
+  struct tableFile tf;
+  const uint64_t* arrayk2 = (const uint64_t*)tableLoad(&tf, "tables/arrayk2_18", TABLE_ARRAYK2, 18, sizeof(uint64_t));
+  if (!arrayk2) {
+    uint64_t* table = (uint64_t*)tableNew(&tf, 18, sizeof(uint64_t));
+    ... make table[] ...
+    tableSave(&tf, "tables/arrayk2_18", TABLE_ARRAYK2, 18, sizeof(uint64_t));
+    arrayk2 = table;
+  }
+  ...
+  tableFree(&tf);
+If the filename is "", tableLoad() returns NULL and tableSave() does nothing,
+  so the table is just made in RAM like before.
+
+Works for C and C++
+
+(c) 2021 Bradley Knockel
+
+****************************************** */
+
+
+#ifndef TABLEFILE_H
+#define TABLEFILE_H
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <process.h>
+#endif
+
+
+
+#define TABLEFILE_MAGIC "COLLATZT"
+#define TABLEFILE_VERSION 1
+
+// the kinds of tables of my codes
+#define TABLE_ARRAYK2 "arrayk2 d+(c<<58)"              // k2 steps, where (3n+1)/2 is one step
+#define TABLE_DELAYK2 "delayk2 int, (3n+1)/2 is 1"     // steps to reach 1 (see reduceTo1 folder)
+
+struct tableFileHeader {
+  char magic[8];          // TABLEFILE_MAGIC
+  uint32_t version;       // TABLEFILE_VERSION
+  uint32_t k2;
+  char kind[32];          // such as "arrayk2 d+(c<<58)"
+  uint64_t entryBytes;
+  uint64_t bytes;         // size of the table, after the header
+  uint64_t checksum;      // tableChecksum() of the table
+};                        // 72 bytes, so the table is aligned
+
+
+
+struct tableFile {
+  void* table;
+  size_t bytes;
+  void* map;              // the whole file if memory mapped, else NULL
+  size_t mapBytes;
+};
+
+
+
+// a quick hash of the 64-bit words of the table (bytes is a multiple of 8)
+static uint64_t tableChecksum(const void* table, size_t bytes) {
+  const uint64_t* w = (const uint64_t*)table;
+  uint64_t h = 14695981039346656037ULL;
+  for (size_t i = 0; i < bytes / 8; i++) h = (h ^ w[i]) * 1099511628211ULL;
+  return h;
+}
+
+static void tableHeader(struct tableFileHeader* h, const char* kind, int k2, size_t entryBytes) {
+  memset(h, 0, sizeof(*h));
+  memcpy(h->magic, TABLEFILE_MAGIC, 8);
+  h->version = TABLEFILE_VERSION;
+  h->k2 = k2;
+  strncpy(h->kind, kind, sizeof(h->kind) - 1);
+  h->entryBytes = entryBytes;
+  h->bytes = (uint64_t)entryBytes << k2;
+}
+
+
+
+static void tableFree(struct tableFile* tf) {
+#ifndef _WIN32
+  if (tf->map) {
+    munmap(tf->map, tf->mapBytes);
+    tf->map = NULL;
+    tf->table = NULL;
+    return;
+  }
+#endif
+  if (tf->table) free((char*)tf->table - sizeof(struct tableFileHeader));
+  tf->table = NULL;
+}
+
+
+
+/*
+  Returns the table in the file, or NULL if there is no good file
+  The table is read-only if memory mapped
+*/
+static const void* tableLoad(struct tableFile* tf, const char* filename, const char* kind, int k2, size_t entryBytes) {
+  tf->table = NULL;
+  tf->bytes = 0;
+  tf->map = NULL;
+  tf->mapBytes = 0;
+  if ( !filename[0] ) return NULL;
+
+  struct tableFileHeader want;
+  tableHeader(&want, kind, k2, entryBytes);
+  size_t fileBytes = sizeof(want) + want.bytes;
+
+#ifndef _WIN32
+
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0) return NULL;
+  struct stat st;
+  if ( fstat(fd, &st) || (size_t)st.st_size != fileBytes ) {
+    close(fd);
+    return NULL;
+  }
+  // MAP_SHARED so that all processes share the page cache
+  void* map = mmap(NULL, fileBytes, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);    // the map stays valid after closing
+  if (map == MAP_FAILED) return NULL;
+  tf->map = map;
+  tf->mapBytes = fileBytes;
+  tf->table = (char*)map + sizeof(want);
+
+#else
+
+  FILE* fp = fopen(filename, "rb");
+  if (!fp) return NULL;
+  char* file = (char*)malloc(fileBytes + 1);
+  size_t got = file ? fread(file, 1, fileBytes + 1, fp) : 0;
+  fclose(fp);
+  if (got != fileBytes) {
+    free(file);
+    return NULL;
+  }
+  tf->table = file + sizeof(want);     // tableFree() frees from the header
+
+#endif
+
+  tf->bytes = want.bytes;
+  const struct tableFileHeader* h = (const struct tableFileHeader*)((char*)tf->table - sizeof(want));
+  want.checksum = h->checksum;
+  if ( memcmp(h, &want, sizeof(want)) || tableChecksum(tf->table, tf->bytes) != h->checksum ) {
+    printf("  table file %s is for a different table or is damaged, so making it again\n", filename);
+    tableFree(tf);
+    return NULL;
+  }
+  return tf->table;
+}
+
+
+
+// for when tableLoad() returns NULL: returns room for the table to be made, or NULL if out of RAM
+static void* tableNew(struct tableFile* tf, int k2, size_t entryBytes) {
+  tf->map = NULL;
+  tf->mapBytes = 0;
+  tf->bytes = entryBytes << k2;
+  char* file = (char*)malloc(sizeof(struct tableFileHeader) + tf->bytes);
+  tf->table = file ? file + sizeof(struct tableFileHeader) : NULL;
+  return tf->table;
+}
+
+
+
+// saves the table made in tableNew() to the file, returning 0 if it worked
+static int tableSave(struct tableFile* tf, const char* filename, const char* kind, int k2, size_t entryBytes) {
+  if ( !filename[0] ) return 0;
+
+  struct tableFileHeader* h = (struct tableFileHeader*)((char*)tf->table - sizeof(struct tableFileHeader));
+  tableHeader(h, kind, k2, entryBytes);
+  h->checksum = tableChecksum(tf->table, tf->bytes);
+
+  // a temporary file for each process, so processes don't write to the same file
+  char tmp[600];
+#ifndef _WIN32
+  snprintf(tmp, sizeof(tmp), "%s.%d.tmp", filename, (int)getpid());
+#else
+  snprintf(tmp, sizeof(tmp), "%s.%d.tmp", filename, (int)_getpid());
+#endif
+  FILE* fp = fopen(tmp, "wb");
+  int err = !fp;
+  if (fp) {
+    err |= fwrite(h, 1, sizeof(*h) + tf->bytes, fp) != sizeof(*h) + tf->bytes;
+    err |= fclose(fp);
+  }
+#ifdef _WIN32
+  if (!err) remove(filename);     // rename() doesn't replace a file on Windows
+#endif
+  if ( err || rename(tmp, filename) ) {
+    remove(tmp);
+    printf("  error: cannot save table file %s!\n", filename);
+    return 1;
+  }
+  return 0;
+}
+
+#endif
@@ -23,7 +23,7 @@ I use __builtin_ctzll(), which should be at least for 64-bit integers.
 Note that I use the "long long" function strtoull() when reading in the arguments.
 
 Sieves of size 2^k are used, where k can be very large!
-Storage drive not used.
+Storage drive not used, unless tables is set (see below and ../partiallySieveless/tableFile.h).
 Minimal RAM used to store the 2^k2 lookup table.
 
 k < 81 must be true
@@ -130,6 +130,9 @@ Here is a neat way to run this code...
 To pick up where you left off, change the start (and stop) value of seq.
 k, TASK_SIZE, and TASK_SIZE0 should not change between runs.
 Change the -P argument of parallel to run more CPU threads at a time!
+Set jsonFile (see below) to also append a JSON line for each task
+  with what was found (see ../partiallySieveless/collatzJson.h),
+  then combine these using ../collatzAggregate.py instead of using grep on log.txt.
 
 For each task_id0, 9 * 2 ^ TASK_SIZE0 numbers will be tested,
   but only after each task_id is run from 0 to ( 2^(k - TASK_SIZE) - 1 )
@@ -171,6 +174,9 @@ Then set the following as your TASK_ID...
 #include <sys/time.h>
 struct timeval tv1, tv2;
 
+#include "../partiallySieveless/tableFile.h"
+#include "../partiallySieveless/collatzJson.h"
+
 #define min(a,b) (((a)<(b))?(a):(b))
 #define max(a,b) (((a)>(b))?(a):(b))
 
@@ -196,6 +202,13 @@ const int TASK_SIZE = 20;        // TASK_SIZE <= k
 */
 const int k2 = 15;
 
+// Set to a folder (that exists) to save arrayk2[] and delayk2[] there the first time,
+//   then to memory map them every run after that. Worth it for large k2
+const char tables[] = "";
+
+// Set to a file to append a JSON line to it for each task (see the top of this file)
+const char jsonFile[] = "";
+
 
 
 
@@ -213,6 +226,31 @@ int stepsMax = 762;
 
 
 
+// what was found, kept to be written to jsonFile
+struct found {
+  int steps;             // 0 if overflow, -1 if steps limit reached
+  __uint128_t nStart;
+};
+struct found* founds = NULL;
+size_t foundCount = 0;
+size_t foundSize = 0;
+
+void addFound(int steps, __uint128_t nStart) {
+  if ( !jsonFile[0] ) return;
+  if ( foundCount == foundSize ) {
+    size_t size = foundSize ? 2*foundSize : 64;
+    struct found* f = (struct found*)realloc(founds, size*sizeof(struct found));
+    if (!f) return;
+    founds = f;
+    foundSize = size;
+  }
+  founds[foundCount].steps = steps;
+  founds[foundCount].nStart = nStart;
+  foundCount++;
+}
+
+
+
 
 // Code will test aStart <= a < aStart + aSteps
 // Set this to 2^0 = 1 to have get an idea of how long processing the sieve takes.
@@ -350,8 +388,23 @@ int main(int argc, char *argv[]) {
   ////////////////////////////////////////////////////////////////
 
 
-  uint64_t *arrayk2 = malloc(sizeof(uint64_t) * ((size_t)1 << k2));
-  int *delayk2 = malloc(sizeof(int) * ((size_t)1 << k2));
+  // read them if they were made before (see ../partiallySieveless/tableFile.h)
+  char arrayName[300] = "";
+  char delayName[300] = "";
+  if ( tables[0] ) {
+    snprintf(arrayName, sizeof(arrayName), "%s/arrayk2_%d", tables, k2);
+    snprintf(delayName, sizeof(delayName), "%s/delayk2_%d", tables, k2);
+  }
+  struct tableFile tfArray, tfDelay;
+  const uint64_t* arrayk2 = (const uint64_t*)tableLoad(&tfArray, arrayName, TABLE_ARRAYK2, k2, sizeof(uint64_t));
+  const int* delayk2 = (const int*)tableLoad(&tfDelay, delayName, TABLE_DELAYK2, k2, sizeof(int));
+
+  if ( !arrayk2 || !delayk2 ) {
+
+  tableFree(&tfArray);
+  tableFree(&tfDelay);
+  uint64_t *arrayTable = (uint64_t*)tableNew(&tfArray, k2, sizeof(uint64_t));
+  int *delayTable = (int*)tableNew(&tfDelay, k2, sizeof(int));
 
   for (size_t index = 0; index < ((size_t)1 << k2); ++index) {
 
@@ -396,13 +449,13 @@ int main(int argc, char *argv[]) {
 next:
 
     /* stores both L and Salpha */
-    arrayk2[index] = L + ((uint64_t)Salpha << 58);
+    arrayTable[index] = L + ((uint64_t)Salpha << 58);
 
     size_t Ssteps = 0;
     if (L == 0) goto finish;
     if (reducedTo1 > 0) {
-      if (index == 1) delayk2[1] = 0;
-      else delayk2[index] = reducedTo1;
+      if (index == 1) delayTable[1] = 0;
+      else delayTable[index] = reducedTo1;
       continue;
     }
 
@@ -430,11 +483,17 @@ next:
 
 finish:
 
-    delayk2[index] = k2 + Ssteps;
-    //delayk2[index] = k2 + Ssteps + Salpha;  // if (3*n + 1)/2 is 2 steps
+    delayTable[index] = k2 + Ssteps;
+    //delayTable[index] = k2 + Ssteps + Salpha;  // if (3*n + 1)/2 is 2 steps
 
   }
 
+  tableSave(&tfArray, arrayName, TABLE_ARRAYK2, k2, sizeof(uint64_t));
+  tableSave(&tfDelay, delayName, TABLE_DELAYK2, k2, sizeof(int));
+  arrayk2 = arrayTable;
+  delayk2 = delayTable;
+  }
+
 
 
 
@@ -550,12 +609,14 @@ finish:
               if (n > maxNs[newC]) {
                   printf("Overflow! nStart = ");
                   print128(nStart);
+                  addFound(0, nStart);
                   break;
               }
               n *= c3[newC];
               if (n > UINTmax - newB) {
                   printf("Overflow! nStart = ");
                   print128(nStart);
+                  addFound(0, nStart);
                   break;
               }
               n += newB;
@@ -566,6 +627,7 @@ finish:
               if (steps > 1000000) {     // must be checked so that steps doesn't overflow
                   printf("Steps limit reached! nStart = ");
                   print128(nStart);
+                  addFound(-1, nStart);
                   break;
               }
 
@@ -579,6 +641,7 @@ finish:
           if (steps > stepsMax) {
             printf(" steps = %i found. nStart = ", steps);
             print128(nStart);
+            addFound(steps, nStart);
           }
 
 
@@ -590,13 +653,70 @@ finish:
   print128(countB);
 
   gettimeofday(&tv2, NULL);
-  printf("  %e seconds\n\n",
-      (double)(tv2.tv_usec - tv1.tv_usec) / 1000000.0 + (double)(tv2.tv_sec - tv1.tv_sec)); 
+  double seconds = (double)(tv2.tv_usec - tv1.tv_usec) / 1000000.0 + (double)(tv2.tv_sec - tv1.tv_sec);
+  printf("  %e seconds\n\n", seconds);
+
+  // the same results as a JSON line (see ../partiallySieveless/collatzJson.h)
+  if ( jsonFile[0] ) {
+    struct jsonRecord json;
+    jsonStart(&json);
+    jsonString(&json, "code", "sieveless_reduceTo1");
+    jsonInt(&json, "k", k);
+    jsonInt(&json, "k1", -1);
+    jsonInt(&json, "k2", k2);
+    jsonInt(&json, "deltaN", (long long)deltaN);
+    jsonInt(&json, "MOD3_POWER", 2);
+    jsonInt(&json, "TASK_SIZE", TASK_SIZE);
+    jsonInt(&json, "TASK_SIZE0", TASK_SIZE0);
+    jsonU128(&json, "task_id0", task_id0);
+    jsonU128(&json, "task_id", task_id);
+    jsonU128(&json, "countB", countB);
+    jsonInt(&json, "stepsMax", stepsMax);
+
+    // the steps found, then the overflows and steps limits (as collatzAggregate.py reads them)
+    int count = 0;
+    jsonKey(&json, "finds");
+    jsonAdd(&json, "[");
+    for (size_t i = 0; i < foundCount; i++) {
+      if (founds[i].steps <= 0) continue;
+      jsonAdd(&json, count++ ? ",{" : "{");
+      jsonInt(&json, "steps", founds[i].steps);
+      jsonU128(&json, "nStart", founds[i].nStart);
+      jsonAdd(&json, "}");
+    }
+    jsonAdd(&json, "]");
+    count = 0;
+    jsonKey(&json, "overflow_list");
+    jsonAdd(&json, "[");
+    for (size_t i = 0; i < foundCount; i++) {
+      if (founds[i].steps != 0) continue;
+      jsonAdd(&json, count++ ? ",{" : "{");
+      jsonU128(&json, "nStart", founds[i].nStart);
+      jsonKey(&json, "finished");
+      jsonAdd(&json, "false}");
+    }
+    jsonAdd(&json, "]");
+    jsonInt(&json, "overflows", count);
+    count = 0;
+    jsonKey(&json, "steps_limit_list");
+    jsonAdd(&json, "[");
+    for (size_t i = 0; i < foundCount; i++) {
+      if (founds[i].steps != -1) continue;
+      jsonAdd(&json, count++ ? ",{" : "{");
+      jsonU128(&json, "nStart", founds[i].nStart);
+      jsonAdd(&json, "}");
+    }
+    jsonAdd(&json, "]");
+
+    jsonDouble(&json, "seconds", seconds);
+    jsonWrite(&json, jsonFile);
+  }
 
   // free memory (cuz why not?)
+  free(founds);
   free(maxNs);
   free(c3);
-  free(arrayk2);
-  free(delayk2);
+  tableFree(&tfArray);
+  tableFree(&tfDelay);
   return 0;
 }
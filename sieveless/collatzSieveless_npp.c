@@ -58,7 +58,7 @@ This works if we test *all* not-excluded numbers n>1.
 
 This code tests all n = A*2^k + B where...
  - B is not excluded by a 2^k sieve
- - n is not excluded by a 3^2 sieve
+ - n is not excluded by a 3^2 sieve (or a 3^m sieve, see collatzMod3.h)
  - aStart <= A < aEnd
 You are free to set k yourself!
 
@@ -79,6 +79,8 @@ A better sieve is to also exclude n%9==4 numbers. This is a 3^2 sieve.
 There are tons of these rules, but almost all exclusions occur with the above rules.
   For example, all mod 3^9 rules will block only a few percent more n than a 3^2 sieve,
   but you won't gain because checking against these rules takes time.
+  Instead of checking each a, the next a that isn't excluded is found by a lookup table
+  (see collatzMod3.h), so compile with -DMOD3_POWER=m to try a 3^m sieve.
 
 
 
@@ -108,6 +110,19 @@ This is a minor improvement worth doing!
 
 If overflow is reached, you may have found a number that
   could disprove the conjecture! Overflow must be carefully checked.
+Numbers that overflow are run again using 256-bit integers (see collatzOverflow256.h),
+  and only numbers that overflow even that print "Overflow! nStart = ".
+Compile with -DCHECKSUM to also print a checksum and the max n (see collatzChecksum.h).
+Run with --json file to also append the results to file as a JSON line (see collatzJson.h).
+Run with --checkpoint name to save checkpoints, so that a stopped task
+  picks up where it left off when run again (see collatzCheckpoint.h).
+Run with --survivors folder to save the b that need testing of each task_id to folder
+  (which must exist), so that running another task_id0 for the same task_id
+  doesn't make the sieve again (see survivorFile.h).
+Run with --task_id0Count count to also run task_id0 + 1 ... task_id0 + count - 1
+  using the same sieve segment, so the sieve is made only once for all of them.
+  The a of these task_id0 are tested for each b before moving to the next b,
+  and the results of each task_id0 are printed (and written to --json) separately.
 If the code gets stuck on a certain number,
   you may also have disproved the conjecture!
 
@@ -136,6 +151,8 @@ Here is a neat way to run this code...
 To pick up where you left off, change the start (and stop) value of seq.
 k, TASK_SIZE, and TASK_SIZE0 should not change between runs.
 Change the -P argument of parallel to run more CPU threads at a time!
+Instead, collatzCoordinator.py (in the main folder) runs the task_id for you,
+  keeping a ledger of which are done, so nothing is skipped even after a crash.
 
 For each task_id0, 9 * 2 ^ TASK_SIZE0 numbers will be tested,
   but only after each task_id is run from 0 to ( 2^(k - TASK_SIZE) - 1 )
@@ -143,8 +160,7 @@ Why the 9? I thought it might help my GPU code, but it only does EXTREMELY SLIGH
 Feel free to get rid of the 9 when aStart and aSteps are defined in the code.
 You'll also want to get rid of the division by 9 when this host program
   checks if task_id0 will cause overflow.
-If task_id0 > 0, you'll also want to fix the line...
-  aMod = 0
+The 3^2 sieve works for any aStart (see collatzMod3.h).
 
 
 
@@ -172,6 +188,14 @@ Then set the following as your task_id...
 #include <sys/time.h>
 struct timeval tv1, tv2;
 
+#include <time.h>
+
+#include "../partiallySieveless/collatzParams.h"
+#include "../partiallySieveless/collatzKsteps.h"
+#include "../partiallySieveless/collatzMod3.h"
+#include "../partiallySieveless/collatzJoin.h"
+#include "../partiallySieveless/survivorFile.h"
+
 
 
 /*
@@ -181,27 +205,29 @@ struct timeval tv1, tv2;
   TASK_SIZE should at least be 10 to give each process something to run!
   Due to the limits of strtoull(), k - TASK_SIZE < 64
   9 * 2^(TASK_SIZE0 + TASK_SIZE - k) numbers will be run by each process
+  These and the other values below are defaults that can be changed
+    at run time, such as by --TASK_SIZE 20 (see collatzParams.h)
 */
-const int k = 51;
-const int TASK_SIZE0 = 67;       // 9 * 2^TASK_SIZE0 numbers will be run total
-const int TASK_SIZE = 20;        // TASK_SIZE <= k
+int k = 51;
+int TASK_SIZE0 = 67;       // 9 * 2^TASK_SIZE0 numbers will be run total
+int TASK_SIZE = 20;        // TASK_SIZE <= k
 
 
 
 
 
-__uint128_t deltaN_max = 222;     // don't let deltaN be larger than this
+int deltaN_max = 222;     // don't let deltaN be larger than this
 
 
 
+char jsonFile[256] = "";  // set by --json to append results as a JSON line
 
+char checkpointFile[256] = "";   // set by --checkpoint to save checkpoints
+int checkpointSeconds = 60;
 
+char survivors[256] = "";   // set by --survivors to keep the b that need testing in this folder
 
-
-// Code will test aStart <= a < aStart + aSteps
-// Set this to 2^0 = 1 to have get an idea of how long processing the sieve takes.
-// Ideally, I like to set this to at least 2^10.
-const __uint128_t aSteps = (__uint128_t)9 << (TASK_SIZE0 - k);
+int task_id0Count = 1;      // set by --task_id0Count to run task_id0 <= id0 < task_id0 + task_id0Count
 
 
 
@@ -219,8 +245,47 @@ void print128(__uint128_t n) {
 
 
 
+// for finishing numbers that overflow 128 bits
+#include "../partiallySieveless/collatzOverflow256.h"
+
+// for the checksum and max n if compiled with -DCHECKSUM
+#include "../partiallySieveless/collatzChecksum.h"
+
+// for --json
+#include "../partiallySieveless/collatzJson.h"
+
+// for --checkpoint
+#include "../partiallySieveless/collatzCheckpoint.h"
+
+
+
+// seconds since some fixed time, for timing each part of the code
+double secondsNow(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1000000000.0;
+}
+
+
+
 int main(int argc, char *argv[]) {
 
+  // read options such as --TASK_SIZE 20 (see collatzParams.h)
+  struct collatzParam params[] = {
+    {"k", &k, NULL, 0},
+    {"TASK_SIZE0", &TASK_SIZE0, NULL, 0},
+    {"TASK_SIZE", &TASK_SIZE, NULL, 0},
+    {"deltaN_max", &deltaN_max, NULL, 0},
+    {"json", NULL, jsonFile, sizeof(jsonFile)},
+    {"checkpoint", NULL, checkpointFile, sizeof(checkpointFile)},
+    {"checkpointSeconds", &checkpointSeconds, NULL, 0},
+    {"survivors", NULL, survivors, sizeof(survivors)},
+    {"task_id0Count", &task_id0Count, NULL, 0},
+    {NULL, NULL, NULL, 0}
+  };
+  argc = paramsParse(params, argc, argv);
+  if ( argc < 0 || paramsCheck(k, -1, -1, TASK_SIZE, TASK_SIZE0) ) return 0;
+
   if( argc < 3 ) {
     printf("Too few arguments. Aborting.\n");
     return 0;
@@ -237,8 +302,17 @@ int main(int argc, char *argv[]) {
     return 0;
   }
 
+  if ( task_id0Count < 1 ) {
+    printf("Aborting. task_id0Count > 0 must be true\n");
+    return 0;
+  }
+
   printf("task_id0 = ");
   print128(task_id0);
+  if ( task_id0Count > 1 ) {
+    printf("task_id0Count = ");
+    print128(task_id0Count);
+  }
   printf("task_id = ");
   print128(task_id);
   printf("task_id must be less than ");
@@ -280,7 +354,11 @@ int main(int argc, char *argv[]) {
     deltaN = deltaNtemp + 1.0;    // add 1 to get ceiling
   }
 
-  if ( deltaN > deltaN_max ) deltaN = deltaN_max;
+  if ( deltaN_max < 0 ) {
+    printf("Aborting. deltaN_max >= 0 must be true\n");
+    return 0;
+  }
+  if ( deltaN > (__uint128_t)deltaN_max ) deltaN = deltaN_max;
 
   printf("  k = %i\n", k);
   printf("  deltaN = ");
@@ -289,21 +367,25 @@ int main(int argc, char *argv[]) {
 
 
 
-  const __uint128_t k2 = (__uint128_t)1 << k;       // 2^k
   const __uint128_t UINTmax = -1;                   // trick to get all bits to be 1
 
 
-  if ( task_id0 > ( (UINTmax / 9) >> (TASK_SIZE0 - k) ) - 1 ) {
+  if ( task_id0 + task_id0Count - 1 > ( (UINTmax / 9) >> (TASK_SIZE0 - k) ) - 1 ) {
     printf("Error: Overflow!\n");
     return 0;
   }
+
+  // Code will test aStart <= a < aStart + aSteps
+  // Set this to 2^0 = 1 to have get an idea of how long processing the sieve takes.
+  // Ideally, I like to set this to at least 2^10.
+  const __uint128_t aSteps = (__uint128_t)9 << (TASK_SIZE0 - k);
   const __uint128_t aStart = (__uint128_t)task_id0*9 << (TASK_SIZE0 - k);
   const __uint128_t aEnd = aStart + aSteps;
 
+  // task_id0 + t has aStart + t*aSteps <= a < aEnd + t*aSteps (see --task_id0Count)
+  const __uint128_t aEndAll = aStart + aSteps*task_id0Count;
 
 
-  // 3 or 9 (the actual code must be changed to match, so keep it at 9)
-  const int modNum = 9;
 
   // 3^c = 2^(log2(3)*c) = 2^(1.585*c),
   //    so c=80 is the max to fit in 128-bit numbers.
@@ -321,17 +403,13 @@ int main(int argc, char *argv[]) {
 
 
 
-  __uint128_t n, nStart, a, m;
-  int alpha, aMod, nMod, bMod;
+  __uint128_t n, nStart, a;
+  int alpha, nMod;
 
 
-  //const int k2Mod = k2 % modNum;
-  //const int k2Mod = (k & 1) ? 2 : 1 ;   // trick for modNum == 3
-  uint64_t r = 0;    // trick for modNum == 9
-  r += (uint64_t)(k2)        & 0xfffffffffffffff;
-  r += (uint64_t)(k2 >>  60) & 0xfffffffffffffff;
-  r += (uint64_t)(k2 >> 120);
-  const int k2Mod = r%9;
+  // lookup tables for the 3^m sieve (see collatzMod3.h)
+  struct mod3Sieve m3;
+  mod3Init(&m3, k);
 
 
 
@@ -351,7 +429,7 @@ int main(int argc, char *argv[]) {
   // Note that after k steps for B = 2^k - 1, B will become 3^k - 1
   //   and A*2^k will become A*3^k
   const __uint128_t maxA = (UINTmax - c3[k] + 1) / c3[k];     // max a
-  if (aEnd - 1 > maxA) {
+  if (aEndAll - 1 > maxA) {
     printf("Error: a*2^k + (2^k - 1) will overflow after k steps!\n");
     return 0;
   }
@@ -367,114 +445,170 @@ int main(int argc, char *argv[]) {
 
   __uint128_t countB = 0;
 
+  // for doing k steps (see collatzKsteps.h) and for the deltaN check (see collatzJoin.h)
+  struct kstepsTable kt;
+  struct joinTable jt;
+  if ( kstepsInit(&kt, KSTEPS_BITS) || joinInit(&jt, &kt, k, deltaN) ) {
+    printf("  error: not enough RAM for deltaN!\n");
+    return 0;
+  }
+
+  /*
+    Counters and timers for the two parts of the code...
+      making the sieve segment: k steps for each b, then deltaN checks
+      testing numbers: the aSteps values of a for each b that needs testing
+    The timer only switches parts when a b needs testing,
+      so the timing costs almost nothing.
+  */
+  uint64_t excludedReduce = 0;    // b ruled out by being reduced in no more than k steps
+  uint64_t excludedJoin = 0;      // b ruled out by joining the path of b - deltaN ... b - 1
+  uint64_t* steps = (uint64_t*)calloc(task_id0Count, sizeof(uint64_t));    // times through the inner loop, each of which is an n++ and an n--
+  uint64_t* overflows = (uint64_t*)calloc(task_id0Count, sizeof(uint64_t));
+  __uint128_t* numbers = (__uint128_t*)calloc(task_id0Count, sizeof(__uint128_t));   // the a not excluded by the 3^m sieve
+
+  // if compiled with -DCHECKSUM (see collatzChecksum.h)
+  struct collatzChecksum* cs = (struct collatzChecksum*)malloc(task_id0Count * sizeof(struct collatzChecksum));
+  for (int t = 0; t < task_id0Count; t++) checksumInit(&cs[t]);
+
+  /*
+    Pick up from a checkpoint (see collatzCheckpoint.h)
+    Saved are the next b, the counters, then steps, overflows, cs, and numbers of each task_id0
+    The deltaN check doesn't need anything saved since collatzJoin.h
+      fills its table again as it goes
+  */
+  const int cpCount = 4 + 6*task_id0Count;
+  __uint128_t* cpValues = (__uint128_t*)malloc(cpCount * sizeof(__uint128_t));
+  char cpID[512];
+  snprintf(cpID, sizeof(cpID), "sieveless_npp k=%d TASK_SIZE=%d TASK_SIZE0=%d deltaN_max=%d task_id0=%llu task_id0Count=%d task_id=%llu",
+      k, TASK_SIZE, TASK_SIZE0, deltaN_max, (unsigned long long)task_id0, task_id0Count, (unsigned long long)task_id);
+  struct checkpoint cp;
+  checkpointInit(&cp, checkpointFile, checkpointSeconds, cpID, task_id0, task_id);
+  __uint128_t bFirst = bStart;
+  if ( checkpointLoad(&cp, cpValues, cpCount) ) {
+    bFirst = cpValues[0];
+    countB = cpValues[1];
+    excludedReduce = (uint64_t)cpValues[2];
+    excludedJoin = (uint64_t)cpValues[3];
+    for (int t = 0; t < task_id0Count; t++) {
+      steps[t] = (uint64_t)cpValues[4 + 6*t];
+      overflows[t] = (uint64_t)cpValues[5 + 6*t];
+      cs[t].checksum = (uint64_t)cpValues[6 + 6*t];
+      cs[t].maxN = cpValues[7 + 6*t];
+      cs[t].maxNstart = cpValues[8 + 6*t];
+      numbers[t] = cpValues[9 + 6*t];
+    }
+  }
+
+  /*
+    With --survivors, the b that need testing may be in a file from
+      a run of another task_id0 (see survivorFile.h)
+    If so, the k steps and the deltaN check are skipped for every b,
+      else this run saves them (unless it picked up from a checkpoint)
+  */
+  struct survivorFile sv;
+  survivorOpen(&sv, survivors, k, TASK_SIZE, (uint64_t)deltaN, task_id, bFirst == bStart);
+  if (sv.reading) survivorSeek(&sv, (uint64_t)(bFirst - bStart + 3));
+  uint64_t loops = 0;
+  double testSeconds = 0.0;
+  double loopStart = secondsNow();
+
   ////////////////////////////////////////////////////////////////
   //////// test integers that aren't excluded by certain rules
   ////////////////////////////////////////////////////////////////
 
-  for (__uint128_t b = bStart; b < bEnd; b += 4) {
+  for (__uint128_t b = bFirst; b < bEnd; b += 4) {
+
+      // save a checkpoint every so often
+      // Each b read from the survivors file needs testing, so check more often then
+      if ( (sv.reading || (++loops & 0xfff) == 0) && b != bFirst && checkpointDue(&cp) ) {
+        cpValues[0] = b;
+        cpValues[1] = countB;
+        cpValues[2] = excludedReduce;
+        cpValues[3] = excludedJoin;
+        for (int t = 0; t < task_id0Count; t++) {
+          cpValues[4 + 6*t] = steps[t];
+          cpValues[5 + 6*t] = overflows[t];
+          cpValues[6 + 6*t] = cs[t].checksum;
+          cpValues[7 + 6*t] = cs[t].maxN;
+          cpValues[8 + 6*t] = cs[t].maxNstart;
+          cpValues[9 + 6*t] = numbers[t];
+        }
+        checkpointSave(&cp, cpValues, cpCount);
+      }
 
       int go = 1;          // acts as a boolean
-      __uint128_t bb = b;  // will become fk(b)
-      int c = 0;           // number of increases experienced when calculated fk(b)
+      __uint128_t bb;      // will become fk(b)
+      int c;               // number of increases experienced when calculated fk(b)
+
+      if (sv.reading) {
+        if ( !survivorNext(&sv, bStart - 3, &b, &bb, &c) ) break;
+        goto test;
+      }
 
       // check to see if 2^k*a + b is reduced in no more than k steps
-      for (j=0; j<k; j++) {   // step
-        if (bb & 1) {         // bitwise test for odd
-          bb = 3*(bb/2) + 2;  // note that bb is odd
-          c++;
-        } else {
-          bb >>= 1;
-          if (bb < b) {      // if 2^k*N + b is reduced to a*N + bb
-            go = 0;
-            break;
-          }
-        }
+      //   (if 2^k*N + b is reduced to a*N + bb with bb < b)
+      if ( kstepsReduce(&kt, b, b, k, &bb, &c) ) {
+        go = 0;
+        excludedReduce++;
       }
 
       // if go=1, use another method to try to get go=0
       if (go) {
 
-        __uint128_t lenList = ((deltaN+1) < (b-1)) ? (deltaN+1) : (b-1) ;   // get min(deltaN+1, b-1)
-        for(m=1; m<lenList; m++) {    // loop over lists
-
-          __uint128_t bm = b - m;
-          int cm = 0;
-
-          // take k steps to get bm and cm
-          for(j=0; j<k; j++) {
-            if (bm & 1) {
-              bm = 3*(bm/2) + 2;
-              cm++;
-            } else {
-              bm >>= 1;
-            }
-          }
-
-          // check bm and cm against bb and c
-          if ( bm == bb && cm == c ) {
-            go = 0;
-            //print128(b);
-            break;
-          }
-      
+        // has b joined the path of b - deltaN ... b - 1 ?
+        if ( joinCheck(&jt, b, bb, c) ) {
+          go = 0;
+          excludedJoin++;
+          //print128(b);
         }
       }
 
       if ( go == 0 ) {
         continue;
       }
-      countB++;
-
-      aMod = 0;
-
-      // a trick for modNum == 9 to get b%9 faster
-      uint64_t r = 0;
-      r += (uint64_t)(b)        & 0xfffffffffffffff;
-      r += (uint64_t)(b >>  60) & 0xfffffffffffffff;
-      r += (uint64_t)(b >> 120);
-      bMod = r%9;
-
-      for (a=aStart; a<aEnd; a++) {    // loop over a before next b (interlacing for speed)
-
-
+      survivorAdd(&sv, (uint64_t)(b - bStart + 3), bb, c);
 
-          // do a 3^2 sieve
-
-          nMod = (aMod * k2Mod + bMod) % modNum;
-
-          // iterate before the following possible continue
-          aMod++;
-          if (aMod == modNum) aMod = 0;
+test:
+      countB++;
 
-          //if (nMod == 2) continue;    // modNum = 3
-          if (nMod == 2 || nMod == 4 || nMod == 5 || nMod == 8) {   // modNum = 9
-            continue;
-          }
+      double testStart = secondsNow();
 
+      // each task_id0 (see --task_id0Count)
+      for (int t = 0; t < task_id0Count; t++) {
+      uint64_t stepsT = 0;
+      numbers[t] += mod3Count(&m3, aStart + t*aSteps, aEnd + t*aSteps, b);
 
+      // do a 3^m sieve by only going to the a that aren't excluded
+      a = aStart + t*aSteps;
+      nMod = mod3First(&m3, &a, b);
 
+      for (; a<aEnd + t*aSteps; a += m3.skip[nMod], nMod = m3.next[nMod]) {    // loop over a before next b (interlacing for speed)
 
           nStart = (a<<k) + b;
 
           n = a*c3[c] + bb;
+          CHECKSUM_ADD(&cs[t], c);
 
 
           if (!(n&1)) goto even;
 
           while (1) {             // go until overflow or n < nStart
 
+            stepsT++;
             n++;
             if ((uint64_t)n == 0) alpha = 64;
             else alpha = __builtin_ctzll(n);
             n >>= alpha;
             //if ( alpha >= lenC3 || n > maxNs[alpha] ) {
             if ( n > maxNs[alpha] ) {
-              printf("Overflow! nStart = ");
-              print128(nStart);
+              overflow256(nStart, kt.step, kt.s);
+              overflows[t]++;
               break;
             }
             n *= c3[alpha];   // 3^c from lookup table
             n--;
+            CHECKSUM_ADD(&cs[t], alpha);
+            CHECKSUM_MAX(&cs[t], n, nStart);
 even:
             if ((uint64_t)n == 0) n >>= 64;
             else n >>= __builtin_ctzll(n);
@@ -484,17 +618,92 @@ even:
 
       }
 
+      steps[t] += stepsT;
+      }
+
+      testSeconds += secondsNow() - testStart;
+
   }
 
+  double loopSeconds = secondsNow() - loopStart;
+
+  if (sv.reading) {
+    excludedReduce = sv.h.reduced;
+    excludedJoin = sv.h.joined;
+  }
+  survivorFinish(&sv, excludedReduce, excludedJoin);
+  survivorClose(&sv);
+
   printf("  Numbers in sieve segment that needed testing = ");
   print128(countB);
 
+  printf("  b looked at = ");
+  print128( ((__uint128_t)1 << TASK_SIZE) / 4 );
+  printf("  b ruled out by reducing in k steps = ");
+  print128(excludedReduce);
+  printf("  b ruled out by joining a path (deltaN) = ");
+  print128(excludedJoin);
+  for (int t = 0; t < task_id0Count; t++) {
+  if ( task_id0Count > 1 ) {
+    printf("task_id0 = ");
+    print128(task_id0 + t);
+  }
+  printf("  numbers tested = ");
+  print128(numbers[t]);
+  printf("  inner loops = ");
+  print128(steps[t]);
+  printf("  inner loops per number = %f\n", numbers[t] ? (double)steps[t] / (double)numbers[t] : 0.0);
+  printf("  overflows = ");
+  print128(overflows[t]);
+  checksumPrint(&cs[t]);
+  }
+  printf("  %e seconds making sieve\n", loopSeconds - testSeconds);
+  printf("  %e seconds testing numbers\n", testSeconds);
+
   gettimeofday(&tv2, NULL);
-  printf("  %e seconds\n\n",
-      (double)(tv2.tv_usec - tv1.tv_usec) / 1000000.0 + (double)(tv2.tv_sec - tv1.tv_sec)); 
+  double seconds = (double)(tv2.tv_usec - tv1.tv_usec) / 1000000.0 + (double)(tv2.tv_sec - tv1.tv_sec);
+  printf("  %e seconds\n\n", seconds);
+
+  // the same results as a JSON line for each task_id0 (see collatzJson.h)
+  // Each task_id0 gets an equal share of the seconds, so that seconds can be added up
+  for (int t = 0; jsonFile[0] && t < task_id0Count; t++) {
+    struct jsonRecord j;
+    jsonStart(&j);
+    jsonString(&j, "code", "sieveless_npp");
+    jsonInt(&j, "k", k);
+    jsonInt(&j, "k1", -1);
+    jsonInt(&j, "k2", -1);
+    jsonInt(&j, "deltaN", (long long)deltaN);
+    jsonInt(&j, "MOD3_POWER", MOD3_POWER);
+    jsonInt(&j, "TASK_SIZE", TASK_SIZE);
+    jsonInt(&j, "TASK_SIZE0", TASK_SIZE0);
+    jsonU128(&j, "task_id0", task_id0 + t);
+    jsonU128(&j, "task_id", task_id);
+    jsonU128(&j, "countB", countB);
+    jsonU128(&j, "b_reduced", excludedReduce);
+    jsonU128(&j, "b_joined", excludedJoin);
+    jsonU128(&j, "numbers", numbers[t]);
+    jsonU128(&j, "steps", steps[t]);
+    jsonU128(&j, "overflow_count", overflows[t]);
+    jsonChecksum(&j, &cs[t]);
+    jsonOverflows(&j, k, bStart - 3, bEnd, aStart + t*aSteps, aEnd + t*aSteps);
+    jsonDouble(&j, "seconds_sieve", (loopSeconds - testSeconds) / task_id0Count);
+    jsonDouble(&j, "seconds_test", testSeconds / task_id0Count);
+    jsonDouble(&j, "seconds", seconds / task_id0Count);
+    if ( jsonWrite(&j, jsonFile) ) break;
+  }
+
+  checkpointRemove(&cp);
 
   // free memory (cuz why not?)
   free(maxNs);
   free(c3);
+  free(steps);
+  free(numbers);
+  free(overflows);
+  free(cs);
+  free(cpValues);
+  joinFree(&jt);
+  kstepsFree(&kt);
   return 0;
 }
@@ -13,12 +13,19 @@ You'll need a 64-bit computer with a not-ancient version of gcc
   in order for __uint128_t to work. This gives a 128-bit integer!
 Compile using something like...
   gcc -O3 collatzSieveless_repeatedKsteps.c
+On a CPU with AVX-512, many numbers are tested at once if compiled using...
+  gcc -O3 -march=native collatzSieveless_repeatedKsteps.c
+See ../partiallySieveless/repeatedKstepsLanes.h
+For large k2, several numbers are stepped in turn so that the lookups of the
+  2^k2 table don't wait on RAM one at a time (see ../partiallySieveless/repeatedKstepsInterleave.h).
 
 I use __builtin_ctzll(), which should be at least for 64-bit integers.
 Note that I use the "long long" function strtoull() when reading in the arguments.
 
 Sieves of size 2^k are used, where k can be very large!
-Storage drive not used.
+Storage drive not used, unless run with --tables folder, in which case the 2^k2 table
+  is saved to folder (which must exist) the first time, then memory mapped by
+  every run after that (see ../partiallySieveless/tableFile.h).
 Minimal RAM used to store the 2^k2 sieve.
 
 k < 81 must be true
@@ -62,7 +69,7 @@ This works if we test *all* not-excluded numbers n>1.
 
 This code tests all n = A*2^k + B where...
  - B is not excluded by a 2^k sieve
- - n is not excluded by a 3^2 sieve
+ - n is not excluded by a 3^2 sieve (or a 3^m sieve, see collatzMod3.h)
  - aStart <= A < aEnd
 You are free to set k yourself!
 
@@ -78,6 +85,8 @@ A better sieve is to also exclude n%9==4 numbers. This is a 3^2 sieve.
 There are tons of these rules, but almost all exclusions occur with the above rules.
   For example, all mod 3^9 rules will block only a few percent more n than a 3^2 sieve,
   but you won't gain because checking against these rules takes time.
+  Instead of checking each a, the next a that isn't excluded is found by a lookup table
+  (see collatzMod3.h), so compile with -DMOD3_POWER=m to try a 3^m sieve.
 
 
 
@@ -107,6 +116,19 @@ This is a minor improvement worth doing!
 
 If overflow is reached, you may have found a number that
   could disprove the conjecture! Overflow must be carefully checked.
+Numbers that overflow are run again using 256-bit integers (see collatzOverflow256.h),
+  and only numbers that overflow even that print "Overflow! nStart = ".
+Compile with -DCHECKSUM to also print a checksum and the max n (see collatzChecksum.h).
+Run with --json file to also append the results to file as a JSON line (see collatzJson.h).
+Run with --checkpoint name to save checkpoints, so that a stopped task
+  picks up where it left off when run again (see collatzCheckpoint.h).
+Run with --survivors folder to save the b that need testing of each task_id to folder
+  (which must exist), so that running another task_id0 for the same task_id
+  doesn't make the sieve again (see survivorFile.h).
+Run with --task_id0Count count to also run task_id0 + 1 ... task_id0 + count - 1
+  using the same sieve segment, so the sieve is made only once for all of them.
+  The a of these task_id0 are tested for each b before moving to the next b,
+  and the results of each task_id0 are printed (and written to --json) separately.
 If the code gets stuck on a certain number,
   you may also have disproved the conjecture!
 
@@ -127,6 +149,8 @@ Here is a neat way to run this code...
 To pick up where you left off, change the start (and stop) value of seq.
 k, TASK_SIZE, and TASK_SIZE0 should not change between runs.
 Change the -P argument of parallel to run more CPU threads at a time!
+Instead, collatzCoordinator.py (in the main folder) runs the task_id for you,
+  keeping a ledger of which are done, so nothing is skipped even after a crash.
 
 For each task_id0, 9 * 2 ^ TASK_SIZE0 numbers will be tested,
   but only after each task_id is run from 0 to ( 2^(k - TASK_SIZE) - 1 )
@@ -134,8 +158,7 @@ Why the 9? I thought it might help my GPU code, but it only does EXTREMELY SLIGH
 Feel free to get rid of the 9 when aStart and aSteps are defined in the code.
 You'll also want to get rid of the division by 9 when this host program
   checks if task_id0 will cause overflow.
-If task_id0 > 0, you'll also want to fix the line...
-  aMod = 0
+The 3^2 sieve works for any aStart (see collatzMod3.h).
 
 
 
@@ -164,6 +187,15 @@ Then set the following as your TASK_ID...
 #include <sys/time.h>
 struct timeval tv1, tv2;
 
+#include <time.h>
+
+#include "../partiallySieveless/collatzParams.h"
+#include "../partiallySieveless/collatzKsteps.h"
+#include "../partiallySieveless/collatzMod3.h"
+#include "../partiallySieveless/collatzJoin.h"
+#include "../partiallySieveless/survivorFile.h"
+#include "../partiallySieveless/tableFile.h"
+
 
 
 /*
@@ -173,10 +205,12 @@ struct timeval tv1, tv2;
   TASK_SIZE should at least be 10 to give each process something to run!
   Due to the limits of strtoull(), k - TASK_SIZE < 64
   9 * 2^(TASK_SIZE0 + TASK_SIZE - k) numbers will be run by each process
+  These and the other values below are defaults that can be changed
+    at run time, such as by --k2 13 (see collatzParams.h)
 */
-const int k = 51;
-const int TASK_SIZE0 = 67;       // 9 * 2^TASK_SIZE0 numbers will be run total
-const int TASK_SIZE = 20;        // TASK_SIZE <= k
+int k = 51;
+int TASK_SIZE0 = 67;       // 9 * 2^TASK_SIZE0 numbers will be run total
+int TASK_SIZE = 20;        // TASK_SIZE <= k
 
 
 
@@ -186,24 +220,26 @@ const int TASK_SIZE = 20;        // TASK_SIZE <= k
   Will use more than 2^(k2 + 3) bytes of RAM
   For my CPU, 11 is the best because it fits in cache
 */
-const int k2 = 11;
+int k2 = 11;
 
 
 
 
 
-__uint128_t deltaN_max = 222;     // don't let deltaN be larger than this
+int deltaN_max = 222;     // don't let deltaN be larger than this
 
 
 
+char jsonFile[256] = "";  // set by --json to append results as a JSON line
 
+char tables[256] = "";    // set by --tables to keep arrayk2[] in this folder (see tableFile.h)
 
+char checkpointFile[256] = "";   // set by --checkpoint to save checkpoints
+int checkpointSeconds = 60;
 
+char survivors[256] = "";   // set by --survivors to keep the b that need testing in this folder
 
-// Code will test aStart <= a < aStart + aSteps
-// Set this to 2^0 = 1 to have get an idea of how long processing the sieve takes.
-// Ideally, I like to set this to at least 2^10.
-const __uint128_t aSteps = (__uint128_t)9 << (TASK_SIZE0 - k);
+int task_id0Count = 1;      // set by --task_id0Count to run task_id0 <= id0 < task_id0 + task_id0Count
 
 
 
@@ -221,8 +257,194 @@ void print128(__uint128_t n) {
 
 
 
+// seconds since some fixed time, for timing each part of the code
+double secondsNow(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1000000000.0;
+}
+
+
+
+// for finishing numbers that overflow 128 bits
+#include "../partiallySieveless/collatzOverflow256.h"
+
+// for the checksum and max n if compiled with -DCHECKSUM
+#include "../partiallySieveless/collatzChecksum.h"
+
+// for --json
+#include "../partiallySieveless/collatzJson.h"
+
+// for --checkpoint
+#include "../partiallySieveless/collatzCheckpoint.h"
+
+// if compiled for AVX-512, defines LANES and testLanes()
+#include "../partiallySieveless/repeatedKstepsLanes.h"
+
+// for large k2, defines INTERLEAVE and testInterleaved()
+#include "../partiallySieveless/repeatedKstepsInterleave.h"
+
+
+
+/*
+  Tests n = a*2^k + b for aStart <= a < aEnd that aren't excluded by the 3^m sieve (see collatzMod3.h)
+  bb = fk(b), c = number of increases in first k steps
+  k2 is an argument so that testAllA() can make the compiler use a constant k2
+  packed is too, and, if 1, arrayk2packed[] is used instead of arrayk2[] (see makeArrayk2packed())
+  Returns how many times k2 steps were done, and adds to overflows and cs (see collatzChecksum.h)
+*/
+static inline __attribute__((always_inline)) uint64_t testA(const int k2, const int packed,
+    const uint64_t* arrayk2, const uint32_t* arrayk2packed, const __uint128_t* c3, const __uint128_t* maxNs,
+    const __uint128_t aStart, const __uint128_t aEnd,
+    const __uint128_t b, const __uint128_t bb, const int c,
+    const struct mod3Sieve* m3, uint64_t* overflows, struct collatzChecksum* cs) {
+
+  const __uint128_t UINTmax = -1;                   // trick to get all bits to be 1
+
+  __uint128_t n, nStart;
+  __uint128_t a = aStart;
+  uint64_t steps = 0;
+
+  // do a 3^m sieve by only going to the a that aren't excluded
+  int nMod = mod3First(m3, &a, b);
+
+  for (; a<aEnd; a += m3->skip[nMod], nMod = m3->next[nMod]) {    // loop over a before next b (interlacing for speed)
+
+      nStart = (a<<k) + b;
+
+      n = a*c3[c] + bb;
+      CHECKSUM_ADD(cs, c);
+
+
+      /* do k2 steps at a time */
+      do {
+          steps++;
+          size_t index = n & ( ((uint64_t)1<<k2) - 1 );  // get lowest k2 bits of n
+          uint64_t newB;
+          size_t newC;
+          if (packed) {
+            newB = arrayk2packed[index];
+            newC = newB >> 27;         // just 5 bits gives c
+            newB &= 0x7ffffff;         // rest of bits gives b
+          } else {
+            newB = arrayk2[index];
+            newC = newB >> 58;    // just 6 bits gives c
+            newB &= 0x3ffffffffffffff;   // rest of bits gives b
+          }
+
+          /* find the new n */
+          //n = (n >> k2)*c3[newC] + newB;
+          n >>= k2;
+          if (n > maxNs[newC]) {
+              overflow256(nStart, arrayk2, k2);
+              (*overflows)++;
+              break;
+          }
+          n *= c3[newC];
+          if (n > UINTmax - newB) {
+              overflow256(nStart, arrayk2, k2);
+              (*overflows)++;
+              break;
+          }
+          n += newB;
+          CHECKSUM_ADD(cs, k2);
+          CHECKSUM_MAX(cs, n, nStart);
+
+          if (n < nStart) break;
+      } while (1);
+
+  }
+
+  return steps;
+}
+
+
+
+/*
+  Since k2 is set at run time, the common values of k2 each get their own copy
+    of testA() with k2 known at compile time, so the inner loop stays fast.
+  Other k2 use the slightly slower testA() with k2 not known.
+  Each also gets a copy for arrayk2packed[], which is used if it isn't NULL.
+*/
+static uint64_t testAllA(const int k2,
+    const uint64_t* arrayk2, const uint32_t* arrayk2packed, const __uint128_t* c3, const __uint128_t* maxNs,
+    const __uint128_t aStart, const __uint128_t aEnd,
+    const __uint128_t b, const __uint128_t bb, const int c,
+    const struct mod3Sieve* m3, uint64_t* overflows, struct collatzChecksum* cs) {
+
+#define TEST_A(K2) ( arrayk2packed ? \
+    testA(K2, 1, arrayk2, arrayk2packed, c3, maxNs, aStart, aEnd, b, bb, c, m3, overflows, cs) : \
+    testA(K2, 0, arrayk2, arrayk2packed, c3, maxNs, aStart, aEnd, b, bb, c, m3, overflows, cs) )
+  switch (k2) {
+    case 10: return TEST_A(10);
+    case 11: return TEST_A(11);
+    case 12: return TEST_A(12);
+    case 13: return TEST_A(13);
+    case 14: return TEST_A(14);
+    case 15: return TEST_A(15);
+    case 16: return TEST_A(16);
+    case 17: return TEST_A(17);
+    case 18: return TEST_A(18);
+    default: return TEST_A(k2);
+  }
+#undef TEST_A
+}
+
+
+
+/*
+  For k2 <= ARRAYK2_PACKED_MAX, each entry of arrayk2[] fits in 32 bits
+    since b < 3^17 < 2^27 and c <= 17 < 2^5,
+    so this makes a copy of arrayk2[] with b + (c<<27) in each entry.
+  This table needs half as much cache, so more of it stays in L1 and L2 cache.
+  On my CPU (48 KiB L1 cache), --tune found k2 = 13 to 17 to be 3% to 5% faster,
+    but, for k2 = 11, the 64-bit table already fits in L1 cache, and it was 2% slower,
+    so it is only used for k2 >= ARRAYK2_PACKED_MIN.
+  The 64-bit arrayk2[] is still needed by overflow256() and by the SIMD lanes.
+  Returns NULL if not used, else free() it when done
+  To not use it, compile with -DNO_PACKED_ARRAYK2
+*/
+#define ARRAYK2_PACKED_MIN 13
+#define ARRAYK2_PACKED_MAX 17
+static uint32_t* makeArrayk2packed(const uint64_t* arrayk2, const int k2) {
+#if defined(NO_PACKED_ARRAYK2) || defined(LANES)
+  (void)arrayk2;
+  (void)k2;
+  return NULL;     // the lanes gather 64-bit entries
+#else
+  if (k2 < ARRAYK2_PACKED_MIN || k2 > ARRAYK2_PACKED_MAX) return NULL;
+  uint32_t* packed = (uint32_t*)malloc(sizeof(uint32_t) << k2);
+  if (!packed) return NULL;
+  for (size_t index = 0; index < ((size_t)1 << k2); index++) {
+    uint64_t newB = arrayk2[index];
+    packed[index] = (uint32_t)(newB & 0x3ffffffffffffff) | (uint32_t)((newB >> 58) << 27);
+  }
+  return packed;
+#endif
+}
+
+
+
 int main(int argc, char *argv[]) {
 
+  // read options such as --k2 13 (see collatzParams.h)
+  struct collatzParam params[] = {
+    {"k", &k, NULL, 0},
+    {"TASK_SIZE0", &TASK_SIZE0, NULL, 0},
+    {"TASK_SIZE", &TASK_SIZE, NULL, 0},
+    {"k2", &k2, NULL, 0},
+    {"deltaN_max", &deltaN_max, NULL, 0},
+    {"json", NULL, jsonFile, sizeof(jsonFile)},
+    {"tables", NULL, tables, sizeof(tables)},
+    {"checkpoint", NULL, checkpointFile, sizeof(checkpointFile)},
+    {"checkpointSeconds", &checkpointSeconds, NULL, 0},
+    {"survivors", NULL, survivors, sizeof(survivors)},
+    {"task_id0Count", &task_id0Count, NULL, 0},
+    {NULL, NULL, NULL, 0}
+  };
+  argc = paramsParse(params, argc, argv);
+  if ( argc < 0 || paramsCheck(k, -1, k2, TASK_SIZE, TASK_SIZE0) ) return 0;
+
   if( argc < 3 ) {
     printf("Too few arguments. Aborting.\n");
     return 0;
@@ -239,8 +461,17 @@ int main(int argc, char *argv[]) {
     return 0;
   }
 
+  if ( task_id0Count < 1 ) {
+    printf("Aborting. task_id0Count > 0 must be true\n");
+    return 0;
+  }
+
   printf("task_id0 = ");
   print128(task_id0);
+  if ( task_id0Count > 1 ) {
+    printf("task_id0Count = ");
+    print128(task_id0Count);
+  }
   printf("task_id = ");
   print128(task_id);
   printf("task_id must be less than ");
@@ -282,7 +513,11 @@ int main(int argc, char *argv[]) {
     deltaN = deltaNtemp + 1.0;    // add 1 to get ceiling
   }
 
-  if ( deltaN > deltaN_max ) deltaN = deltaN_max;
+  if ( deltaN_max < 0 ) {
+    printf("Aborting. deltaN_max >= 0 must be true\n");
+    return 0;
+  }
+  if ( deltaN > (__uint128_t)deltaN_max ) deltaN = deltaN_max;
 
   printf("  k = %i\n", k);
   printf("  deltaN = ");
@@ -293,21 +528,25 @@ int main(int argc, char *argv[]) {
 
 
 
-  const __uint128_t kk = (__uint128_t)1 << k;       // 2^k
   const __uint128_t UINTmax = -1;                   // trick to get all bits to be 1
 
 
-  if ( task_id0 > ( (UINTmax / 9) >> (TASK_SIZE0 - k) ) - 1 ) {
+  if ( task_id0 + task_id0Count - 1 > ( (UINTmax / 9) >> (TASK_SIZE0 - k) ) - 1 ) {
     printf("Error: Overflow!\n");
     return 0;
   }
+
+  // Code will test aStart <= a < aStart + aSteps
+  // Set this to 2^0 = 1 to have get an idea of how long processing the sieve takes.
+  // Ideally, I like to set this to at least 2^10.
+  const __uint128_t aSteps = (__uint128_t)9 << (TASK_SIZE0 - k);
   const __uint128_t aStart = (__uint128_t)task_id0*9 << (TASK_SIZE0 - k);
   const __uint128_t aEnd = aStart + aSteps;
 
+  // task_id0 + t has aStart + t*aSteps <= a < aEnd + t*aSteps (see --task_id0Count)
+  const __uint128_t aEndAll = aStart + aSteps*task_id0Count;
 
 
-  // 3 or 9 (the actual code must be changed to match, so keep it at 9)
-  const int modNum = 9;
 
   // 3^c = 2^(log2(3)*c) = 2^(1.585*c),
   //    so c=80 is the max to fit in 128-bit numbers.
@@ -318,17 +557,9 @@ int main(int argc, char *argv[]) {
 
 
 
-  __uint128_t n, nStart, a, m;
-  int alpha, aMod, nMod, bMod;
-
-
-  //const int kkMod = kk % modNum;
-  //const int kkMod = (k & 1) ? 2 : 1 ;   // trick for modNum == 3
-  uint64_t r = 0;    // trick for modNum == 9
-  r += (uint64_t)(kk)        & 0xfffffffffffffff;
-  r += (uint64_t)(kk >>  60) & 0xfffffffffffffff;
-  r += (uint64_t)(kk >> 120);
-  const int kkMod = r%9;
+  // lookup tables for the 3^m sieve (see collatzMod3.h)
+  struct mod3Sieve m3;
+  mod3Init(&m3, k);
 
 
 
@@ -343,12 +574,18 @@ int main(int argc, char *argv[]) {
   __uint128_t* maxNs = (__uint128_t*)malloc(lenC3*sizeof(__uint128_t));
   for (j=0; j<lenC3; j++) { maxNs[j] = UINTmax / c3[j]; }
 
+#ifdef LANES
+  // 3^c for c <= k2 as 64-bit numbers for the SIMD lanes
+  uint64_t c3small[21];
+  for (j=0; j<21; j++) { c3small[j] = (j<lenC3) ? (uint64_t)c3[j] : 0; }
+#endif
+
 
   // Test a for overflow
   // Note that after k steps for B = 2^k - 1, B will become 3^k - 1
   //   and A*2^k will become A*3^k
   const __uint128_t maxA = (UINTmax - c3[k] + 1) / c3[k];     // max a
-  if (aEnd - 1 > maxA) {
+  if (aEndAll - 1 > maxA) {
     printf("Error: a*2^k + (2^k - 1) will overflow after k steps!\n");
     return 0;
   }
@@ -370,7 +607,15 @@ int main(int argc, char *argv[]) {
 
 #define min(a,b) (((a)<(b))?(a):(b))
 
-  uint64_t *arrayk2 = malloc(sizeof(uint64_t) * ((size_t)1 << k2));
+  // with --tables, read it if it was made before (see tableFile.h)
+  char tableName[300] = "";
+  if ( tables[0] ) snprintf(tableName, sizeof(tableName), "%s/arrayk2_%d", tables, k2);
+  struct tableFile tf;
+  const uint64_t* arrayk2 = (const uint64_t*)tableLoad(&tf, tableName, TABLE_ARRAYK2, k2, sizeof(uint64_t));
+
+  if ( !arrayk2 ) {
+
+  uint64_t *table = (uint64_t*)tableNew(&tf, k2, sizeof(uint64_t));
 
   for (size_t index = 0; index < ((size_t)1 << k2); ++index) {
 
@@ -412,10 +657,16 @@ int main(int argc, char *argv[]) {
 next:
 
     /* stores both L and Salpha */
-    arrayk2[index] = L + ((uint64_t)Salpha << 58);
+    table[index] = L + ((uint64_t)Salpha << 58);
+
+  }
 
+  tableSave(&tf, tableName, TABLE_ARRAYK2, k2, sizeof(uint64_t));
+  arrayk2 = table;
   }
 
+  uint32_t* arrayk2packed = makeArrayk2packed(arrayk2, k2);
+
 
 
 
@@ -429,134 +680,234 @@ next:
 
   __uint128_t countB = 0;
 
-  for (__uint128_t b = bStart; b < bEnd; b += 4) {
+  // for doing k steps (see collatzKsteps.h) and for the deltaN check (see collatzJoin.h)
+  struct kstepsTable kt;
+  struct joinTable jt;
+  if ( kstepsInit(&kt, KSTEPS_BITS) || joinInit(&jt, &kt, k, deltaN) ) {
+    printf("  error: not enough RAM for deltaN!\n");
+    return 0;
+  }
 
-      int go = 1;          // acts as a boolean
-      __uint128_t bb = b;  // will become fk(b)
-      int c = 0;           // number of increases experienced when calculated fk(b)
+  /*
+    Counters and timers for the two parts of the code...
+      making the sieve segment: k steps for each b, then deltaN checks
+      testing numbers: the aSteps values of a for each b that needs testing
+    The timer only switches parts when a b needs testing,
+      so the timing costs almost nothing.
+  */
+  uint64_t excludedReduce = 0;    // b ruled out by being reduced in no more than k steps
+  uint64_t excludedJoin = 0;      // b ruled out by joining the path of b - deltaN ... b - 1
+  uint64_t* steps = (uint64_t*)calloc(task_id0Count, sizeof(uint64_t));    // how many times k2 steps were done
+  uint64_t* overflows = (uint64_t*)calloc(task_id0Count, sizeof(uint64_t));
+  __uint128_t* numbers = (__uint128_t*)calloc(task_id0Count, sizeof(__uint128_t));   // the a not excluded by the 3^m sieve
+
+  // if compiled with -DCHECKSUM (see collatzChecksum.h)
+  struct collatzChecksum* cs = (struct collatzChecksum*)malloc(task_id0Count * sizeof(struct collatzChecksum));
+  for (int t = 0; t < task_id0Count; t++) checksumInit(&cs[t]);
+
+  /*
+    Pick up from a checkpoint (see collatzCheckpoint.h)
+    Saved are the next b, the counters, then steps, overflows, cs, and numbers of each task_id0
+    The deltaN check doesn't need anything saved since collatzJoin.h
+      fills its table again as it goes
+  */
+  const int cpCount = 4 + 6*task_id0Count;
+  __uint128_t* cpValues = (__uint128_t*)malloc(cpCount * sizeof(__uint128_t));
+  char cpID[512];
+  snprintf(cpID, sizeof(cpID), "sieveless_repeatedKsteps k=%d k2=%d TASK_SIZE=%d TASK_SIZE0=%d deltaN_max=%d task_id0=%llu task_id0Count=%d task_id=%llu",
+      k, k2, TASK_SIZE, TASK_SIZE0, deltaN_max, (unsigned long long)task_id0, task_id0Count, (unsigned long long)task_id);
+  struct checkpoint cp;
+  checkpointInit(&cp, checkpointFile, checkpointSeconds, cpID, task_id0, task_id);
+  __uint128_t bFirst = bStart;
+  if ( checkpointLoad(&cp, cpValues, cpCount) ) {
+    bFirst = cpValues[0];
+    countB = cpValues[1];
+    excludedReduce = (uint64_t)cpValues[2];
+    excludedJoin = (uint64_t)cpValues[3];
+    for (int t = 0; t < task_id0Count; t++) {
+      steps[t] = (uint64_t)cpValues[4 + 6*t];
+      overflows[t] = (uint64_t)cpValues[5 + 6*t];
+      cs[t].checksum = (uint64_t)cpValues[6 + 6*t];
+      cs[t].maxN = cpValues[7 + 6*t];
+      cs[t].maxNstart = cpValues[8 + 6*t];
+      numbers[t] = cpValues[9 + 6*t];
+    }
+  }
 
-      // check to see if 2^k*N + b is reduced in no more than k steps
-      for (j=0; j<k; j++) {   // step
-        if (bb & 1) {         // bitwise test for odd
-          bb = 3*(bb/2) + 2;  // note that bb is odd
-          c++;
-        } else {
-          bb >>= 1;
-          if (bb < b) {      // if 2^k*N + b is reduced to a*N + bb
-            go = 0;
-            break;
-          }
+  /*
+    With --survivors, the b that need testing may be in a file from
+      a run of another task_id0 (see survivorFile.h)
+    If so, the k steps and the deltaN check are skipped for every b,
+      else this run saves them (unless it picked up from a checkpoint)
+  */
+  struct survivorFile sv;
+  survivorOpen(&sv, survivors, k, TASK_SIZE, (uint64_t)deltaN, task_id, bFirst == bStart);
+  if (sv.reading) survivorSeek(&sv, (uint64_t)(bFirst - bStart + 3));
+  uint64_t loops = 0;
+  double testSeconds = 0.0;
+  double loopStart = secondsNow();
+
+  for (__uint128_t b = bFirst; b < bEnd; b += 4) {
+
+      // save a checkpoint every so often
+      // Each b read from the survivors file needs testing, so check more often then
+      if ( (sv.reading || (++loops & 0xfff) == 0) && b != bFirst && checkpointDue(&cp) ) {
+        cpValues[0] = b;
+        cpValues[1] = countB;
+        cpValues[2] = excludedReduce;
+        cpValues[3] = excludedJoin;
+        for (int t = 0; t < task_id0Count; t++) {
+          cpValues[4 + 6*t] = steps[t];
+          cpValues[5 + 6*t] = overflows[t];
+          cpValues[6 + 6*t] = cs[t].checksum;
+          cpValues[7 + 6*t] = cs[t].maxN;
+          cpValues[8 + 6*t] = cs[t].maxNstart;
+          cpValues[9 + 6*t] = numbers[t];
         }
+        checkpointSave(&cp, cpValues, cpCount);
       }
 
-      // if go=1, use another method to try to get go=0
-      if (go) {
+      int go = 1;          // acts as a boolean
+      __uint128_t bb;      // will become fk(b)
+      int c;               // number of increases experienced when calculated fk(b)
 
-        __uint128_t lenList = ((deltaN+1) < (b-1)) ? (deltaN+1) : (b-1) ;   // get min(deltaN+1, b-1)
-        for(m=1; m<lenList; m++) {    // loop over lists
+      if (sv.reading) {
+        if ( !survivorNext(&sv, bStart - 3, &b, &bb, &c) ) break;
+        goto test;
+      }
 
-          __uint128_t bm = b - m;
-          int cm = 0;
+      // check to see if 2^k*N + b is reduced in no more than k steps
+      //   (if 2^k*N + b is reduced to a*N + bb with bb < b)
+      if ( kstepsReduce(&kt, b, b, k, &bb, &c) ) {
+        go = 0;
+        excludedReduce++;
+      }
 
-          // take k steps to get bm and cm
-          for(j=0; j<k; j++) {
-            if (bm & 1) {
-              bm = 3*(bm/2) + 2;
-              cm++;
-            } else {
-              bm >>= 1;
-            }
-          }
+      // if go=1, use another method to try to get go=0
+      if (go) {
 
-          // check bm and cm against bb and c
-          if ( bm == bb && cm == c ) {
-            go = 0;
-            //print128(b);
-            break;
-          }
-      
+        // has b joined the path of b - deltaN ... b - 1 ?
+        if ( joinCheck(&jt, b, bb, c) ) {
+          go = 0;
+          excludedJoin++;
+          //print128(b);
         }
       }
 
       if ( go == 0 ) {
         continue;
       }
-      countB++;
-
-      aMod = 0;
-
-      // a trick for modNum == 9 to get b%9 faster
-      uint64_t r = 0;
-      r += (uint64_t)(b)        & 0xfffffffffffffff;
-      r += (uint64_t)(b >>  60) & 0xfffffffffffffff;
-      r += (uint64_t)(b >> 120);
-      bMod = r%9;
-
-      for (a=aStart; a<aEnd; a++) {    // loop over a before next b (interlacing for speed)
-
-
-
-          // do a 3^2 sieve
-
-          nMod = (aMod * kkMod + bMod) % modNum;
-
-          // iterate before the following possible continue
-          aMod++;
-          if (aMod == modNum) aMod = 0;
-
-          //if (nMod == 2) continue;    // modNum = 3
-          if (nMod == 2 || nMod == 4 || nMod == 5 || nMod == 8) {   // modNum = 9
-            continue;
-          }
-
+      survivorAdd(&sv, (uint64_t)(b - bStart + 3), bb, c);
 
+test:
+      countB++;
 
+      double testStart = secondsNow();
+
+      // each task_id0 (see --task_id0Count)
+      for (int t = 0; t < task_id0Count; t++) {
+        const __uint128_t aFirst = aStart + t*aSteps;
+        numbers[t] += mod3Count(&m3, aFirst, aFirst + aSteps, b);
+#ifdef LANES
+        // step many a at once (see repeatedKstepsLanes.h)
+        if (k2 < 21)
+          steps[t] += testLanes(arrayk2, k2, c3, c3small, k, aFirst, aFirst + aSteps, b, bb, c, &m3, &overflows[t], &cs[t]);
+        else
+#endif
+#ifdef INTERLEAVE
+        // step many a in turn so that the large table doesn't wait on RAM (see repeatedKstepsInterleave.h)
+        if (k2 >= INTERLEAVE_K2)
+          steps[t] += testInterleaved(arrayk2, k2, c3, maxNs, k, aFirst, aFirst + aSteps, b, bb, c, &m3, &overflows[t], &cs[t]);
+        else
+#endif
+        steps[t] += testAllA(k2, arrayk2, arrayk2packed, c3, maxNs, aFirst, aFirst + aSteps, b, bb, c, &m3, &overflows[t], &cs[t]);
+      }
 
-          nStart = (a<<k) + b;
-
-          n = a*c3[c] + bb;
-
-
-          /* do k2 steps at a time */
-          do {
-              size_t index = n & ( ((uint64_t)1<<k2) - 1 );  // get lowest k2 bits of n
-              uint64_t newB = arrayk2[index];
-              size_t newC = newB >> 58;    // just 6 bits gives c
-              newB &= 0x3ffffffffffffff;   // rest of bits gives b
+      testSeconds += secondsNow() - testStart;
 
-              /* find the new n */
-              //n = (n >> k2)*c3[newC] + newB;
-              n >>= k2;
-              if (n > maxNs[newC]) {
-                  printf("Overflow! nStart = ");
-                  print128(nStart);
-                  break;
-              }
-              n *= c3[newC];
-              if (n > UINTmax - newB) {
-                  printf("Overflow! nStart = ");
-                  print128(nStart);
-                  break;
-              }
-              n += newB;
+  }
 
-              if (n < nStart) break;
-          } while (1);
-
-      }
+  double loopSeconds = secondsNow() - loopStart;
 
+  if (sv.reading) {
+    excludedReduce = sv.h.reduced;
+    excludedJoin = sv.h.joined;
   }
+  survivorFinish(&sv, excludedReduce, excludedJoin);
+  survivorClose(&sv);
 
   printf("  Numbers in sieve segment that needed testing = ");
   print128(countB);
 
+  printf("  b looked at = ");
+  print128( ((__uint128_t)1 << TASK_SIZE) / 4 );
+  printf("  b ruled out by reducing in k steps = ");
+  print128(excludedReduce);
+  printf("  b ruled out by joining a path (deltaN) = ");
+  print128(excludedJoin);
+  for (int t = 0; t < task_id0Count; t++) {
+  if ( task_id0Count > 1 ) {
+    printf("task_id0 = ");
+    print128(task_id0 + t);
+  }
+  printf("  numbers tested = ");
+  print128(numbers[t]);
+  printf("  k2 steps = ");
+  print128(steps[t]);
+  printf("  k2 steps per number = %f\n", numbers[t] ? (double)steps[t] / (double)numbers[t] : 0.0);
+  printf("  overflows = ");
+  print128(overflows[t]);
+  checksumPrint(&cs[t]);
+  }
+  printf("  %e seconds making sieve\n", loopSeconds - testSeconds);
+  printf("  %e seconds testing numbers\n", testSeconds);
+
   gettimeofday(&tv2, NULL);
-  printf("  %e seconds\n\n",
-      (double)(tv2.tv_usec - tv1.tv_usec) / 1000000.0 + (double)(tv2.tv_sec - tv1.tv_sec)); 
+  double seconds = (double)(tv2.tv_usec - tv1.tv_usec) / 1000000.0 + (double)(tv2.tv_sec - tv1.tv_sec);
+  printf("  %e seconds\n\n", seconds);
+
+  // the same results as a JSON line for each task_id0 (see collatzJson.h)
+  // Each task_id0 gets an equal share of the seconds, so that seconds can be added up
+  for (int t = 0; jsonFile[0] && t < task_id0Count; t++) {
+    struct jsonRecord j;
+    jsonStart(&j);
+    jsonString(&j, "code", "sieveless_repeatedKsteps");
+    jsonInt(&j, "k", k);
+    jsonInt(&j, "k1", -1);
+    jsonInt(&j, "k2", k2);
+    jsonInt(&j, "deltaN", (long long)deltaN);
+    jsonInt(&j, "MOD3_POWER", MOD3_POWER);
+    jsonInt(&j, "TASK_SIZE", TASK_SIZE);
+    jsonInt(&j, "TASK_SIZE0", TASK_SIZE0);
+    jsonU128(&j, "task_id0", task_id0 + t);
+    jsonU128(&j, "task_id", task_id);
+    jsonU128(&j, "countB", countB);
+    jsonU128(&j, "b_reduced", excludedReduce);
+    jsonU128(&j, "b_joined", excludedJoin);
+    jsonU128(&j, "numbers", numbers[t]);
+    jsonU128(&j, "steps", steps[t]);
+    jsonU128(&j, "overflow_count", overflows[t]);
+    jsonChecksum(&j, &cs[t]);
+    jsonOverflows(&j, k, bStart - 3, bEnd, aStart + t*aSteps, aEnd + t*aSteps);
+    jsonDouble(&j, "seconds_sieve", (loopSeconds - testSeconds) / task_id0Count);
+    jsonDouble(&j, "seconds_test", testSeconds / task_id0Count);
+    jsonDouble(&j, "seconds", seconds / task_id0Count);
+    if ( jsonWrite(&j, jsonFile) ) break;
+  }
+
+  checkpointRemove(&cp);
 
   // free memory (cuz why not?)
   free(maxNs);
   free(c3);
-  free(arrayk2);
+  free(steps);
+  free(numbers);
+  free(overflows);
+  free(cs);
+  free(cpValues);
+  joinFree(&jt);
+  kstepsFree(&kt);
+  free(arrayk2packed);
+  tableFree(&tf);
   return 0;
 }